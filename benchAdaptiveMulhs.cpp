@@ -0,0 +1,145 @@
+// Sweep the enumeration threshold of adaptiveMulhs and report the precision
+// gained over KnownBits::mulhs against the latency added.
+//
+// The query set is either every pair of abstract values of one width or the
+// mulhs records of a trace written by recordTrace.
+
+#include "AbstractTF/AdaptiveMulhs.h"
+#include "AbstractTF/Compare.h"
+#include "AbstractTF/Enumeration.h"
+#include "AbstractTF/Trace.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using llvm::KnownBits;
+using namespace abstracttf;
+
+using Query = std::pair<KnownBits, KnownBits>;
+
+// Each configuration is timed this many times and the fastest run is kept
+static constexpr unsigned Repetitions = 3;
+
+// Widest width for the all-pairs query set. Every pair is held in memory
+// with two result vectors, about 130 bytes per pair: 9^7 pairs take
+// 600 MB, 9^8 would take 5.6 GB.
+static constexpr unsigned MaxBenchBitWidth = 7;
+
+// Best wall time in nanoseconds of running `fn` on every query, plus the
+// results
+template <typename Fn>
+static double timeQueries(const std::vector<Query> &queries, Fn &&fn,
+                          std::vector<KnownBits> &results) {
+  double best = 0.0;
+  for (unsigned rep = 0; rep < Repetitions; rep++) {
+    results.clear();
+    results.reserve(queries.size());
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (const Query &query : queries)
+      results.push_back(fn(query.first, query.second));
+    auto t2 = std::chrono::high_resolution_clock::now();
+    double time = (t2 - t1).count();
+    if (rep == 0 || time < best)
+      best = time;
+  }
+  return best;
+}
+
+static void printUsage() {
+  std::cout << "Usage: benchAdaptiveMulhs <bitWidth> | <trace.bin>"
+            << std::endl;
+  std::cout << "       <bitWidth> is 1-" << MaxBenchBitWidth
+            << "; wider queries go through a trace" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    printUsage();
+    return 1;
+  }
+
+  std::vector<Query> queries;
+  std::string source = argv[1];
+  char *end = nullptr;
+  unsigned long bw = std::strtoul(argv[1], &end, 10);
+  if (*end == '\0') {
+    if (bw == 0 || bw > MaxBenchBitWidth) {
+      printUsage();
+      return 1;
+    }
+    std::vector<KnownBits> all = enumerateFromBitWidth(bw);
+    queries.reserve(all.size() * all.size());
+    for (const KnownBits &lhs : all)
+      for (const KnownBits &rhs : all)
+        queries.emplace_back(lhs, rhs);
+    source = "all pairs at BitWidth = " + source;
+  } else {
+    TraceReader trace;
+    std::string error;
+    if (!trace.open(argv[1], error)) {
+      std::cerr << error << std::endl;
+      return 1;
+    }
+    for (const TraceRecord &record : trace) {
+      if (!record.isValid()) {
+        std::cerr << argv[1] << ": invalid record "
+                  << &record - trace.begin() << std::endl;
+        return 1;
+      }
+      queries.emplace_back(record.lhs(), record.rhs());
+    }
+  }
+  if (queries.empty()) {
+    std::cerr << "No mulhs queries" << std::endl;
+    return 1;
+  }
+
+  std::vector<KnownBits> composite, adaptive;
+  double compositeTime =
+      timeQueries(queries, KnownBits::mulhs, composite) / queries.size();
+
+  std::cout << "adaptiveMulhs threshold sweep over " << queries.size()
+            << " queries (" << source << ")" << std::endl;
+  std::cout << "Composite average time: " << compositeTime << " ns"
+            << std::endl;
+  std::printf("%12s %10s %12s %12s %12s %12s\n", "Threshold", "Exact %",
+              "MorePrecise", "BitsGained", "AvgTime(ns)", "Added(ns)");
+
+  for (uint64_t threshold = 1; threshold <= (uint64_t(1) << 24);
+       threshold <<= 2) {
+    double time = timeQueries(
+                      queries,
+                      [threshold](const KnownBits &lhs, const KnownBits &rhs) {
+                        return adaptiveMulhs(lhs, rhs, threshold);
+                      },
+                      adaptive) /
+                  queries.size();
+
+    uint64_t enumerated = 0, morePrecise = 0, bitsGained = 0;
+    for (size_t i = 0; i < queries.size(); i++) {
+      if (adaptiveMulhsEnumerates(queries[i].first, queries[i].second,
+                                  threshold))
+        enumerated++;
+      // An unsound composite can know bits the adaptive result does not;
+      // only strict refinements count as gains.
+      if (comparePrecision(adaptive[i], composite[i]) ==
+          PrecisionOrder::FirstMorePrecise) {
+        morePrecise++;
+        bitsGained += knownBitCount(adaptive[i]) - knownBitCount(composite[i]);
+      }
+    }
+
+    std::printf("%12llu %10.2f %12llu %12llu %12.1f %12.1f\n",
+                static_cast<unsigned long long>(threshold),
+                100.0 * enumerated / queries.size(),
+                static_cast<unsigned long long>(morePrecise),
+                static_cast<unsigned long long>(bitsGained), time,
+                time - compositeTime);
+  }
+  return 0;
+}
@@ -0,0 +1,31 @@
+#include "Modes.h"
+
+#include "AbstractTF/AlgorithmSweep.h"
+#include "AbstractTF/Progress.h"
+
+#include <chrono>
+#include <iostream>
+
+using namespace abstracttf;
+
+int runAlgorithmMode(unsigned bitWidth, unsigned numThreads,
+                     std::chrono::seconds progressInterval) {
+  AlgorithmSweepFn sweep = getAlgorithmSweep(bitWidth);
+  if (!sweep) {
+    std::cerr << "--algorithms supports bit widths 1-" << MaxFixedBitWidth
+              << std::endl;
+    return 1;
+  }
+
+  uint64_t totalKnownBits = numKnownBits(bitWidth);
+  ProgressReporter progress("mulhs algorithms bw=" + std::to_string(bitWidth),
+                            totalKnownBits * totalKnownBits, numThreads,
+                            progressInterval, std::cerr);
+  SweepOptions options;
+  options.numThreads = numThreads;
+  options.progress = &progress;
+
+  AlgorithmSweepResult result = sweep(options);
+  printAlgorithmSweepResult(std::cout, result);
+  return 0;
+}
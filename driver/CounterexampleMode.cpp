@@ -0,0 +1,32 @@
+#include "Modes.h"
+
+#include "AbstractTF/Counterexamples.h"
+#include "AbstractTF/Progress.h"
+
+#include <chrono>
+#include <iostream>
+
+using namespace abstracttf;
+
+int runCounterexampleMode(unsigned bitWidth, unsigned numThreads,
+                          std::chrono::seconds progressInterval,
+                          size_t maxExamples) {
+  CounterexampleSearchFn search = getCounterexampleSearch(bitWidth);
+  if (!search) {
+    std::cerr << "--counterexamples supports bit widths 1-"
+              << MaxCounterexampleBitWidth << std::endl;
+    return 1;
+  }
+
+  uint64_t totalKnownBits = numKnownBits(bitWidth);
+  ProgressReporter progress("maximal mulhs bw=" + std::to_string(bitWidth),
+                            totalKnownBits * totalKnownBits, numThreads,
+                            progressInterval, std::cerr);
+  SweepOptions options;
+  options.numThreads = numThreads;
+  options.progress = &progress;
+
+  CounterexampleResult result = search(options, maxExamples);
+  printCounterexampleResult(std::cout, result);
+  return 0;
+}
@@ -0,0 +1,206 @@
+#include "Modes.h"
+
+#include "AbstractTF/Histogram.h"
+#include "AbstractTF/OracleTable.h"
+#include "AbstractTF/Parallel.h"
+#include "AbstractTF/Progress.h"
+#include "AbstractTF/QueryProtocol.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace abstracttf;
+
+namespace {
+// Set by SIGINT and SIGTERM, polled by the accept loop.
+volatile std::sig_atomic_t StopRequested = 0;
+
+// Records evaluated per parallel work item within one request
+constexpr size_t QueryChunkSize = 256;
+
+struct DaemonStats {
+  std::mutex lock;
+  uint64_t requests = 0;
+  uint64_t records = 0;
+  uint64_t byStatus[4] = {};
+  LatencyHistogram latency; // Per request, nanoseconds
+};
+
+struct Connection {
+  int fd = -1;
+  std::atomic<bool> finished{false};
+  std::thread worker;
+};
+} // namespace
+
+// Answers requests on `fd` until the client disconnects or sends a
+// malformed request.
+static void serveConnection(Connection &connection,
+                            const std::vector<OracleTable> &tables,
+                            unsigned numThreads, DaemonStats &stats) {
+  int fd = connection.fd;
+  std::vector<TraceRecord> records;
+  std::vector<QueryResult> results;
+  TraceHeader request;
+  while (readFully(fd, &request, sizeof(request))) {
+    if (std::memcmp(request.magic, "KBTR", 4) != 0 ||
+        request.version != TraceVersion ||
+        request.numRecords > MaxQueryRecords) {
+      std::cerr << "Closing connection after a malformed request"
+                << std::endl;
+      break;
+    }
+    records.resize(request.numRecords);
+    if (!readFully(fd, records.data(), records.size() * sizeof(TraceRecord)))
+      break;
+
+    auto start = std::chrono::steady_clock::now();
+    results.resize(records.size());
+    size_t numChunks = (records.size() + QueryChunkSize - 1) / QueryChunkSize;
+    parallelFor(numChunks, numThreads, [&](size_t chunk, unsigned) {
+      size_t end = std::min(records.size(), (chunk + 1) * QueryChunkSize);
+      for (size_t i = chunk * QueryChunkSize; i < end; i++)
+        results[i] = answerMulhsQuery(records[i], tables);
+    });
+    QueryResponseHeader response;
+    response.numResults = results.size();
+    response.latencyNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+    if (!writeFully(fd, &response, sizeof(response)) ||
+        !writeFully(fd, results.data(), results.size() * sizeof(QueryResult)))
+      break;
+
+    std::lock_guard<std::mutex> guard(stats.lock);
+    stats.requests++;
+    stats.records += results.size();
+    for (const QueryResult &result : results)
+      stats.byStatus[result.status]++;
+    stats.latency.record(response.latencyNs);
+    std::cerr << "Request " << stats.requests << ": " << results.size()
+              << " records in " << response.latencyNs / 1000.0 << " us"
+              << std::endl;
+  }
+  ::shutdown(fd, SHUT_RDWR);
+  connection.finished = true;
+}
+
+int runDaemonMode(const std::string &socketPath, unsigned tableWidth,
+                  const std::string &tableDir, unsigned numThreads,
+                  std::chrono::seconds progressInterval) {
+  if (tableWidth > MaxOracleTableBitWidth) {
+    std::cerr << "--tables supports bit widths 0-" << MaxOracleTableBitWidth
+              << std::endl;
+    return 1;
+  }
+  sockaddr_un addr;
+  std::string error;
+  if (!makeSocketAddress(socketPath, addr, error)) {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+
+  std::vector<OracleTable> tables;
+  if (!loadOracleTables(tableWidth, tableDir, numThreads, progressInterval,
+                        std::cerr, tables))
+    return 1;
+
+  // A socket left behind by an earlier daemon would make bind fail. Only
+  // remove it once a connect shows nobody is listening on it any more.
+  struct stat st;
+  if (::stat(socketPath.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+    int probeFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    int probe = probeFd < 0 ? -1
+                            : ::connect(probeFd,
+                                        reinterpret_cast<sockaddr *>(&addr),
+                                        sizeof(addr));
+    int probeErrno = errno;
+    if (probeFd >= 0)
+      ::close(probeFd);
+    if (probe == 0) {
+      std::cerr << socketPath << ": address in use by a running daemon"
+                << std::endl;
+      return 1;
+    }
+    if (probeErrno == ECONNREFUSED)
+      ::unlink(socketPath.c_str());
+  }
+  int listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listenFd < 0 ||
+      ::bind(listenFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) !=
+          0 ||
+      ::listen(listenFd, SOMAXCONN) != 0) {
+    std::cerr << socketPath << ": " << std::strerror(errno) << std::endl;
+    if (listenFd >= 0)
+      ::close(listenFd);
+    return 1;
+  }
+
+  std::signal(SIGINT, [](int) { StopRequested = 1; });
+  std::signal(SIGTERM, [](int) { StopRequested = 1; });
+  std::cerr << "Listening on " << socketPath << std::endl;
+
+  DaemonStats stats;
+  std::list<Connection> connections;
+  uint64_t totalConnections = 0;
+  auto reap = [&](Connection &connection) {
+    connection.worker.join();
+    ::close(connection.fd);
+  };
+  while (!StopRequested) {
+    connections.remove_if([&](Connection &connection) {
+      if (!connection.finished)
+        return false;
+      reap(connection);
+      return true;
+    });
+    pollfd pfd{listenFd, POLLIN, 0};
+    if (::poll(&pfd, 1, /*timeout ms=*/200) <= 0)
+      continue;
+    int fd = ::accept(listenFd, nullptr, nullptr);
+    if (fd < 0)
+      continue;
+    Connection &connection = connections.emplace_back();
+    connection.fd = fd;
+    connection.worker = std::thread(serveConnection, std::ref(connection),
+                                    std::cref(tables), numThreads,
+                                    std::ref(stats));
+    totalConnections++;
+  }
+
+  // Wake connections blocked in read, then wait for them
+  ::close(listenFd);
+  ::unlink(socketPath.c_str());
+  for (Connection &connection : connections)
+    ::shutdown(connection.fd, SHUT_RDWR);
+  for (Connection &connection : connections)
+    reap(connection);
+
+  std::cout << "Daemon on " << socketPath << ": " << totalConnections
+            << " connections, " << stats.requests << " requests, "
+            << stats.records << " records" << std::endl;
+  std::cout << "Records by status:";
+  for (unsigned status = 0; status < 4; status++)
+    std::cout << " " << queryStatusName(static_cast<QueryStatus>(status))
+              << " " << stats.byStatus[status];
+  std::cout << std::endl;
+  if (stats.requests)
+    std::cout << "Request latency (ns): p50 " << stats.latency.percentile(50)
+              << ", p90 " << stats.latency.percentile(90) << ", p99 "
+              << stats.latency.percentile(99) << ", max "
+              << stats.latency.max() << std::endl;
+  return 0;
+}
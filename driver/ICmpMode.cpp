@@ -0,0 +1,53 @@
+#include "Modes.h"
+
+#include "AbstractTF/ICmpSweep.h"
+#include "AbstractTF/Progress.h"
+
+#include <chrono>
+#include <iostream>
+
+using namespace abstracttf;
+
+int runICmpMode(const std::vector<ICmpPredicate> &preds, unsigned bitWidth,
+                unsigned numThreads, std::chrono::seconds progressInterval,
+                bool profileLatency, unsigned slowestCount, bool reportBusy) {
+  ICmpSweepFn sweep = getICmpFixedWidthSweep(bitWidth);
+  if (!sweep) {
+    std::cerr << "--icmp supports bit widths 1-" << MaxFixedBitWidth
+              << std::endl;
+    return 1;
+  }
+  if (profileLatency && preds.size() != 1) {
+    std::cerr << "--latency with --icmp takes a single predicate"
+              << std::endl;
+    return 1;
+  }
+
+  uint64_t totalKnownBits = numKnownBits(bitWidth);
+  ProgressReporter progress(std::to_string(preds.size()) + " predicates bw=" +
+                                std::to_string(bitWidth),
+                            totalKnownBits * totalKnownBits * preds.size(),
+                            numThreads, progressInterval, std::cerr);
+  SweepOptions options;
+  options.numThreads = numThreads;
+  options.progress = &progress;
+  LatencyProfile latency(bitWidth, slowestCount);
+  if (profileLatency)
+    options.latency = &latency;
+  ScheduleStats schedule;
+  options.schedule = &schedule;
+
+  std::vector<ICmpSweepResult> results = sweep(preds, options);
+  for (size_t k = 0; k < preds.size(); k++)
+    printICmpSweepResult(std::cout, icmpPredicateName(preds[k]), results[k]);
+  if (profileLatency)
+    latency.print(std::cout);
+  if (reportBusy)
+    schedule.print(std::cout);
+
+  // A decided predicate the oracle contradicts is a soundness bug
+  for (const ICmpSweepResult &result : results)
+    if (result.counts.compositeMorePrecise || result.counts.incomparableResults)
+      return 1;
+  return 0;
+}
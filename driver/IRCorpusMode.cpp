@@ -0,0 +1,131 @@
+#include "Modes.h"
+
+#include "AbstractTF/Allocations.h"
+#include "AbstractTF/Compare.h"
+#include "AbstractTF/IRCorpus.h"
+#include "AbstractTF/MulhsOracle.h"
+#include "AbstractTF/Parallel.h"
+
+#include <chrono>
+#include <iostream>
+#include <map>
+
+using llvm::KnownBits;
+using namespace abstracttf;
+
+namespace {
+struct SiteResult {
+  bool compared = false;
+  PrecisionOrder order = PrecisionOrder::Same;
+  double timeComposite = 0.0;
+  double timeNaive = 0.0;
+  AllocationCounts compositeAllocations;
+  AllocationCounts naiveAllocations;
+};
+
+struct WidthSummary {
+  uint64_t sites = 0;
+  uint64_t compared = 0;
+  uint64_t knownBits = 0; // Summed over both operands
+  PrecisionCounts counts;
+  double totalTimeComposite = 0.0;
+  double totalTimeNaive = 0.0;
+  AllocationCounts compositeAllocations;
+  AllocationCounts naiveAllocations;
+};
+} // namespace
+
+int runIRCorpusMode(const std::vector<std::string> &files,
+                    unsigned numThreads) {
+  CorpusScanResult scan = scanCorpus(files, numThreads);
+  for (const std::string &error : scan.errors)
+    std::cerr << error << std::endl;
+
+  std::vector<SiteResult> results(scan.sites.size());
+  parallelFor(scan.sites.size(), numThreads, [&](size_t i, unsigned) {
+    const MulhsSite &site = scan.sites[i];
+    SiteResult &result = results[i];
+
+    KnownBits composite;
+    {
+      AllocationScope scope(result.compositeAllocations);
+      auto t1 = std::chrono::high_resolution_clock::now();
+      composite = KnownBits::mulhs(site.lhs, site.rhs);
+      auto t2 = std::chrono::high_resolution_clock::now();
+      result.timeComposite = (t2 - t1).count();
+    }
+
+    llvm::Optional<KnownBits> naive;
+    {
+      AllocationScope scope(result.naiveAllocations);
+      auto t1 = std::chrono::high_resolution_clock::now();
+      naive = tryExactMulhs(site.lhs, site.rhs);
+      auto t2 = std::chrono::high_resolution_clock::now();
+      result.timeNaive = (t2 - t1).count();
+    }
+    if (!naive)
+      return;
+    result.compared = true;
+    result.order = comparePrecision(composite, *naive);
+  });
+
+  std::map<unsigned, WidthSummary> byWidth;
+  for (size_t i = 0; i < scan.sites.size(); i++) {
+    const MulhsSite &site = scan.sites[i];
+    const SiteResult &result = results[i];
+    WidthSummary &summary = byWidth[site.getBitWidth()];
+    summary.sites++;
+    summary.knownBits += knownBitCount(site.lhs) + knownBitCount(site.rhs);
+    summary.totalTimeComposite += result.timeComposite;
+    summary.compositeAllocations += result.compositeAllocations;
+    if (!result.compared)
+      continue;
+    summary.compared++;
+    summary.totalTimeNaive += result.timeNaive;
+    summary.naiveAllocations += result.naiveAllocations;
+    summary.counts.add(result.order);
+  }
+
+  std::cout << "IR corpus: " << scan.modulesParsed << " modules parsed, "
+            << scan.errors.size() << " failed" << std::endl;
+  std::cout << "mulhs sites found: " << scan.sites.size() << std::endl
+            << std::endl;
+
+  for (const auto &[bw, summary] : byWidth) {
+    std::cout << "BitWidth = " << bw << std::endl;
+    std::cout << "Sites: " << summary.sites << " (" << summary.compared
+              << " compared, " << summary.sites - summary.compared
+              << " undecided by the oracle)" << std::endl;
+    std::cout << "Average known bits per operand: "
+              << double(summary.knownBits) / (2 * summary.sites) << std::endl;
+    std::cout << "Composite transfer function more precise: "
+              << summary.counts.compositeMorePrecise << std::endl;
+    std::cout << "Naive transfer function more precise: "
+              << summary.counts.naiveMorePrecise << std::endl;
+    std::cout << "Same precision for both transfer functions: "
+              << summary.counts.samePrecision << std::endl;
+    std::cout << "Incomparable results: "
+              << summary.counts.incomparableResults << std::endl;
+    std::cout << "Average composite time: "
+              << summary.totalTimeComposite / summary.sites << std::endl;
+    if (summary.compared)
+      std::cout << "Average naive time: "
+                << summary.totalTimeNaive / summary.compared << std::endl;
+    if (AllocationCountingEnabled) {
+      const AllocationCounts &composite = summary.compositeAllocations;
+      const AllocationCounts &naive = summary.naiveAllocations;
+      std::cout << "Average composite allocations: "
+                << double(composite.allocations) / summary.sites << " ("
+                << double(composite.bytes) / summary.sites << " bytes)"
+                << std::endl;
+      if (summary.compared)
+        std::cout << "Average naive allocations: "
+                  << double(naive.allocations) / summary.compared << " ("
+                  << double(naive.bytes) / summary.compared << " bytes)"
+                  << std::endl;
+    }
+    std::cout << std::endl;
+  }
+
+  return scan.errors.empty() ? 0 : 1;
+}
@@ -0,0 +1,102 @@
+// Entry points of the testMulhs modes other than the default exhaustive
+// sweep. Each returns the process exit code.
+
+#ifndef TESTMULHS_MODES_H
+#define TESTMULHS_MODES_H
+
+#include "AbstractTF/BinaryOps.h"
+#include "AbstractTF/ICmpSweep.h"
+#include "AbstractTF/RangeDomain.h"
+#include "AbstractTF/UnaryOps.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// --daemon <socket>: answer batched mulhs queries over a Unix domain socket
+// from oracle tables preloaded up to `tableWidth`, cached in `tableDir`
+// when it is not empty.
+int runDaemonMode(const std::string &socketPath, unsigned tableWidth,
+                  const std::string &tableDir, unsigned numThreads,
+                  std::chrono::seconds progressInterval);
+
+// --query <socket> <lhs> <rhs> ...: send one batch of pairs to a daemon and
+// print its answers.
+int runQueryMode(const std::string &socketPath,
+                 const std::vector<std::string> &operands);
+
+// --stream <file|->: read "lhs rhs" lines in 01? notation and write each
+// pair's composite and optimal mulhs, in input order, evaluated in batches
+// of `batchSize`.
+int runStreamMode(const std::string &inputPath, size_t batchSize,
+                  unsigned tableWidth, const std::string &tableDir,
+                  unsigned numThreads, std::chrono::seconds progressInterval);
+
+// --ir <files...>: measure mulhs idioms found in .ll/.bc modules.
+int runIRCorpusMode(const std::vector<std::string> &files, unsigned numThreads);
+
+// --replay <trace.bin>: benchmark composite vs. oracle over a recorded trace.
+int runReplayMode(const std::string &tracePath, unsigned numThreads,
+                  size_t batchSize);
+
+// --sat <bitWidth> [count] [seed]: spot-check random pairs with the SAT
+// oracle.
+int runSatMode(unsigned bitWidth, uint64_t count, uint64_t seed,
+               unsigned numThreads);
+
+// --ops <list> <bitWidth>: sweep several binary operators over one shared
+// enumeration.
+int runMultiOpMode(const std::vector<abstracttf::BinaryOp> &ops,
+                   unsigned bitWidth, unsigned numThreads,
+                   std::chrono::seconds progressInterval, bool reportBusy);
+
+// --unary <list> <bitWidth>: sweep unary operators over every abstract
+// value of one width.
+int runUnaryMode(const std::vector<abstracttf::UnaryOp> &ops,
+                 unsigned bitWidth, unsigned numThreads,
+                 std::chrono::seconds progressInterval);
+
+// --icmp <list> <bitWidth>: evaluate the KnownBits comparison predicates.
+// Fails if LLVM ever decides a predicate the oracle does not.
+int runICmpMode(const std::vector<abstracttf::ICmpPredicate> &preds,
+                unsigned bitWidth, unsigned numThreads,
+                std::chrono::seconds progressInterval, bool profileLatency,
+                unsigned slowestCount, bool reportBusy);
+
+// --range <list> <bitWidth>: sweep ConstantRange transfer functions over
+// every pair of ranges of one width.
+int runRangeMode(const std::vector<abstracttf::RangeOp> &ops,
+                 unsigned bitWidth, unsigned numThreads,
+                 std::chrono::seconds progressInterval, bool reportBusy);
+
+// --reduced <bitWidth>: mulhs on the reduced product of KnownBits and
+// ConstantRange.
+int runReducedProductMode(unsigned bitWidth, unsigned numThreads,
+                          std::chrono::seconds progressInterval,
+                          bool reportBusy);
+
+// --monotone <list> <bitWidth>: check that refining an operand never loses
+// precision in the result. Fails on any violation.
+int runMonotoneMode(const std::vector<abstracttf::BinaryOp> &ops,
+                    unsigned bitWidth, unsigned numThreads,
+                    std::chrono::seconds progressInterval, size_t maxExamples);
+
+// --counterexamples <bitWidth>: report the most general pairs at which
+// KnownBits::mulhs is not optimal, pruning their refinements.
+int runCounterexampleMode(unsigned bitWidth, unsigned numThreads,
+                          std::chrono::seconds progressInterval,
+                          size_t maxExamples);
+
+// --saturation <bitWidth>: products the mulhs oracle evaluates before its
+// result is top, in ordinary and corner-first order.
+int runSaturationMode(unsigned bitWidth, unsigned numThreads,
+                      std::chrono::seconds progressInterval);
+
+// --algorithms <bitWidth>: precision and latency of the alternative mulhs
+// algorithms against the optimal result and KnownBits::mulhs.
+int runAlgorithmMode(unsigned bitWidth, unsigned numThreads,
+                     std::chrono::seconds progressInterval);
+
+#endif // TESTMULHS_MODES_H
@@ -0,0 +1,38 @@
+#include "Modes.h"
+
+#include "AbstractTF/Monotonicity.h"
+#include "AbstractTF/Progress.h"
+
+#include <chrono>
+#include <iostream>
+
+using namespace abstracttf;
+
+int runMonotoneMode(const std::vector<BinaryOp> &ops, unsigned bitWidth,
+                    unsigned numThreads, std::chrono::seconds progressInterval,
+                    size_t maxExamples) {
+  MonotonicityCheckFn check = getMonotonicityCheck(bitWidth);
+  if (!check) {
+    std::cerr << "--monotone supports bit widths 1-" << MaxMonotoneBitWidth
+              << std::endl;
+    return 1;
+  }
+
+  // Every pair is visited twice: once to fill the table, once to check it
+  uint64_t totalKnownBits = numKnownBits(bitWidth);
+  ProgressReporter progress(std::to_string(ops.size()) + " ops monotone bw=" +
+                                std::to_string(bitWidth),
+                            2 * totalKnownBits * totalKnownBits * ops.size(),
+                            numThreads, progressInterval, std::cerr);
+  SweepOptions options;
+  options.numThreads = numThreads;
+  options.progress = &progress;
+
+  bool monotone = true;
+  for (BinaryOp op : ops) {
+    MonotonicityResult result = check(op, options, maxExamples);
+    printMonotonicityResult(std::cout, binaryOpName(op), result);
+    monotone &= result.violations() == 0;
+  }
+  return monotone ? 0 : 1;
+}
@@ -0,0 +1,44 @@
+#include "Modes.h"
+
+#include "AbstractTF/MultiOpSweep.h"
+#include "AbstractTF/Progress.h"
+
+#include <chrono>
+#include <iostream>
+
+using namespace abstracttf;
+
+int runMultiOpMode(const std::vector<BinaryOp> &ops, unsigned bitWidth,
+                   unsigned numThreads, std::chrono::seconds progressInterval,
+                   bool reportBusy) {
+  MultiOpSweepFn sweep = getMultiOpFixedWidthSweep(bitWidth);
+  if (!sweep) {
+    std::cerr << "--ops supports bit widths 1-" << MaxFixedBitWidth
+              << std::endl;
+    return 1;
+  }
+
+  uint64_t totalKnownBits = numKnownBits(bitWidth);
+  ProgressReporter progress(std::to_string(ops.size()) + " ops bw=" +
+                                std::to_string(bitWidth),
+                            totalKnownBits * totalKnownBits * ops.size(),
+                            numThreads, progressInterval, std::cerr);
+  SweepOptions options;
+  options.numThreads = numThreads;
+  options.progress = &progress;
+  ScheduleStats schedule;
+  options.schedule = &schedule;
+
+  auto wallStart = std::chrono::steady_clock::now();
+  std::vector<SweepResult> results = sweep(ops, options);
+  std::chrono::duration<double> wallTime =
+      std::chrono::steady_clock::now() - wallStart;
+
+  for (size_t k = 0; k < ops.size(); k++)
+    printSweepResult(std::cout, binaryOpName(ops[k]), results[k]);
+  std::cout << "Wall time for " << ops.size()
+            << " operators: " << wallTime.count() << " s" << std::endl;
+  if (reportBusy)
+    schedule.print(std::cout);
+  return 0;
+}
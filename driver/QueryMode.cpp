@@ -0,0 +1,55 @@
+#include "Modes.h"
+
+#include "AbstractTF/Format.h"
+#include "AbstractTF/QueryProtocol.h"
+
+#include <chrono>
+#include <iostream>
+
+using namespace abstracttf;
+
+int runQueryMode(const std::string &socketPath,
+                 const std::vector<std::string> &operands) {
+  std::vector<TraceRecord> records;
+  for (size_t i = 0; i + 1 < operands.size(); i += 2) {
+    KnownBits lhs, rhs;
+    if (!parseKnownBits(operands[i], lhs) ||
+        !parseKnownBits(operands[i + 1], rhs) ||
+        lhs.getBitWidth() != rhs.getBitWidth() ||
+        lhs.getBitWidth() > MaxTraceBitWidth) {
+      std::cerr << "Bad operand pair: " << operands[i] << " "
+                << operands[i + 1] << std::endl;
+      return 1;
+    }
+    records.push_back(TraceRecord::make(TraceOp::Mulhs, lhs, rhs));
+  }
+
+  QueryClient client;
+  std::string error;
+  if (!client.connect(socketPath, error)) {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+  std::vector<QueryResult> results;
+  uint64_t latencyNs = 0;
+  auto start = std::chrono::steady_clock::now();
+  if (!client.query(records, results, latencyNs, error)) {
+    std::cerr << socketPath << ": " << error << std::endl;
+    return 1;
+  }
+  std::chrono::duration<double, std::micro> roundTrip =
+      std::chrono::steady_clock::now() - start;
+
+  for (size_t i = 0; i < results.size(); i++) {
+    const QueryResult &result = results[i];
+    QueryStatus status = static_cast<QueryStatus>(result.status);
+    std::cout << "mulhs(" << formatKnownBits(records[i].lhs()) << ", "
+              << formatKnownBits(records[i].rhs()) << ") = "
+              << formatKnownBits(result.composite()) << ", optimal "
+              << formatKnownBits(result.optimal()) << " ("
+              << queryStatusName(status) << ")" << std::endl;
+  }
+  std::cout << "Latency: " << latencyNs / 1000.0 << " us in the daemon, "
+            << roundTrip.count() << " us round trip" << std::endl;
+  return 0;
+}
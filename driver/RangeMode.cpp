@@ -0,0 +1,47 @@
+#include "Modes.h"
+
+#include "AbstractTF/Progress.h"
+#include "AbstractTF/RangeSweep.h"
+
+#include <chrono>
+#include <iostream>
+
+using namespace abstracttf;
+
+int runRangeMode(const std::vector<RangeOp> &ops, unsigned bitWidth,
+                 unsigned numThreads, std::chrono::seconds progressInterval,
+                 bool reportBusy) {
+  RangeSweepFn sweep = getRangeFixedWidthSweep(bitWidth);
+  if (!sweep) {
+    std::cerr << "--range supports bit widths 1-" << MaxRangeBitWidth
+              << std::endl;
+    return 1;
+  }
+
+  uint64_t total = numRanges(bitWidth);
+  ProgressReporter progress(std::to_string(ops.size()) + " range ops bw=" +
+                                std::to_string(bitWidth),
+                            total * total * ops.size(), numThreads,
+                            progressInterval, std::cerr);
+  SweepOptions options;
+  options.numThreads = numThreads;
+  options.progress = &progress;
+  ScheduleStats schedule;
+  options.schedule = &schedule;
+
+  auto wallStart = std::chrono::steady_clock::now();
+  std::vector<RangeSweepResult> results = sweep(ops, options);
+  std::chrono::duration<double> wallTime =
+      std::chrono::steady_clock::now() - wallStart;
+
+  for (size_t k = 0; k < ops.size(); k++)
+    printRangeSweepResult(std::cout,
+                          ("ConstantRange " + std::string(rangeOpName(ops[k])))
+                              .c_str(),
+                          results[k]);
+  std::cout << "Wall time for " << ops.size()
+            << " operators: " << wallTime.count() << " s" << std::endl;
+  if (reportBusy)
+    schedule.print(std::cout);
+  return 0;
+}
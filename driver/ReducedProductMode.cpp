@@ -0,0 +1,41 @@
+#include "Modes.h"
+
+#include "AbstractTF/Progress.h"
+#include "AbstractTF/ReducedProduct.h"
+
+#include <chrono>
+#include <iostream>
+
+using namespace abstracttf;
+
+int runReducedProductMode(unsigned bitWidth, unsigned numThreads,
+                          std::chrono::seconds progressInterval,
+                          bool reportBusy) {
+  ReducedProductSweepFn sweep = getReducedProductSweep(bitWidth);
+  if (!sweep) {
+    std::cerr << "--reduced supports bit widths 1-" << MaxRangeBitWidth
+              << std::endl;
+    return 1;
+  }
+
+  // The sweep sets the total once it knows how many distinct elements
+  // survive normalization
+  ProgressReporter progress("reduced mulhs bw=" + std::to_string(bitWidth), 0,
+                            numThreads, progressInterval, std::cerr);
+  SweepOptions options;
+  options.numThreads = numThreads;
+  options.progress = &progress;
+  ScheduleStats schedule;
+  options.schedule = &schedule;
+
+  auto wallStart = std::chrono::steady_clock::now();
+  ReducedProductResult result = sweep(options);
+  std::chrono::duration<double> wallTime =
+      std::chrono::steady_clock::now() - wallStart;
+
+  printReducedProductResult(std::cout, result);
+  std::cout << "Wall time: " << wallTime.count() << " s" << std::endl;
+  if (reportBusy)
+    schedule.print(std::cout);
+  return 0;
+}
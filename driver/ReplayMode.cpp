@@ -0,0 +1,155 @@
+#include "Modes.h"
+
+#include "AbstractTF/Compare.h"
+#include "AbstractTF/MulhsOracle.h"
+#include "AbstractTF/Parallel.h"
+#include "AbstractTF/Trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <llvm/Support/ErrorHandling.h>
+#include <map>
+
+using llvm::KnownBits;
+using namespace abstracttf;
+
+namespace {
+struct ReplayStats {
+  uint64_t records = 0;
+  uint64_t compared = 0;
+  PrecisionCounts counts;
+  double totalTimeComposite = 0.0;
+  double totalTimeNaive = 0.0;
+
+  ReplayStats &operator+=(const ReplayStats &other) {
+    records += other.records;
+    compared += other.compared;
+    counts += other.counts;
+    totalTimeComposite += other.totalTimeComposite;
+    totalTimeNaive += other.totalTimeNaive;
+    return *this;
+  }
+};
+
+// Per-thread accumulators, keyed by the raw op byte of the trace.
+struct alignas(64) ThreadStats {
+  std::map<uint8_t, ReplayStats> byOp;
+};
+} // namespace
+
+static KnownBits replayComposite(TraceOp op, const KnownBits &lhs,
+                                 const KnownBits &rhs) {
+  switch (op) {
+  case TraceOp::Mulhs:
+    return KnownBits::mulhs(lhs, rhs);
+  }
+  llvm_unreachable("Unknown trace op");
+}
+
+static llvm::Optional<KnownBits> replayOracle(TraceOp op, const KnownBits &lhs,
+                                              const KnownBits &rhs) {
+  switch (op) {
+  case TraceOp::Mulhs:
+    return tryExactMulhs(lhs, rhs);
+  }
+  llvm_unreachable("Unknown trace op");
+}
+
+int runReplayMode(const std::string &tracePath, unsigned numThreads,
+                  size_t batchSize) {
+  TraceReader trace;
+  std::string error;
+  if (!trace.open(tracePath, error)) {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+  for (const TraceRecord &record : trace) {
+    if (!record.isValid()) {
+      std::cerr << tracePath << ": invalid record " << &record - trace.begin()
+                << " (op " << unsigned(record.op) << ", width "
+                << unsigned(record.bitWidth) << ")" << std::endl;
+      return 1;
+    }
+  }
+
+  batchSize = std::max<size_t>(1, batchSize);
+  size_t numBatches = (trace.size() + batchSize - 1) / batchSize;
+  std::vector<ThreadStats> threadStats(numThreads);
+
+  auto wallStart = std::chrono::steady_clock::now();
+  parallelFor(numBatches, numThreads, [&](size_t batch, unsigned thread) {
+    uint64_t begin = batch * batchSize;
+    uint64_t end = std::min<uint64_t>(begin + batchSize, trace.size());
+
+    // Decode the batch first so only the transfer functions are timed
+    std::vector<KnownBits> lhs, rhs, composite;
+    lhs.reserve(end - begin);
+    rhs.reserve(end - begin);
+    composite.reserve(end - begin);
+    for (uint64_t i = begin; i < end; i++) {
+      lhs.push_back(trace[i].lhs());
+      rhs.push_back(trace[i].rhs());
+    }
+
+    // Composite over the whole batch, timed as one block
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (uint64_t i = begin; i < end; i++)
+      composite.push_back(replayComposite(TraceOp(trace[i].op),
+                                          lhs[i - begin], rhs[i - begin]));
+    auto t2 = std::chrono::high_resolution_clock::now();
+    double batchTime = (t2 - t1).count();
+
+    for (uint64_t i = begin; i < end; i++) {
+      const KnownBits &l = lhs[i - begin];
+      const KnownBits &r = rhs[i - begin];
+      ReplayStats &stats = threadStats[thread].byOp[trace[i].op];
+      stats.records++;
+      stats.totalTimeComposite += batchTime / (end - begin);
+
+      t1 = std::chrono::high_resolution_clock::now();
+      llvm::Optional<KnownBits> naive = replayOracle(TraceOp(trace[i].op), l, r);
+      t2 = std::chrono::high_resolution_clock::now();
+      if (!naive)
+        continue;
+      stats.totalTimeNaive += (t2 - t1).count();
+      stats.compared++;
+      stats.counts.add(comparePrecision(composite[i - begin], *naive));
+    }
+  });
+  std::chrono::duration<double> wallTime =
+      std::chrono::steady_clock::now() - wallStart;
+
+  std::map<uint8_t, ReplayStats> byOp;
+  for (const ThreadStats &stats : threadStats)
+    for (const auto &[op, opStats] : stats.byOp)
+      byOp[op] += opStats;
+
+  std::cout << "Replaying " << tracePath << ": " << trace.size()
+            << " records in " << numBatches << " batches of up to "
+            << batchSize << " on " << numThreads << " threads" << std::endl
+            << std::endl;
+  for (const auto &[op, stats] : byOp) {
+    std::cout << "Op: " << traceOpName(TraceOp(op)) << std::endl;
+    std::cout << "Records: " << stats.records << " (" << stats.compared
+              << " compared, " << stats.records - stats.compared
+              << " undecided by the oracle)" << std::endl;
+    std::cout << "Composite transfer function more precise: "
+              << stats.counts.compositeMorePrecise << std::endl;
+    std::cout << "Naive transfer function more precise: "
+              << stats.counts.naiveMorePrecise << std::endl;
+    std::cout << "Same precision for both transfer functions: "
+              << stats.counts.samePrecision << std::endl;
+    std::cout << "Incomparable results: " << stats.counts.incomparableResults
+              << std::endl;
+    std::cout << "Average composite time: "
+              << stats.totalTimeComposite / stats.records << std::endl;
+    if (stats.compared)
+      std::cout << "Average naive time: "
+                << stats.totalTimeNaive / stats.compared << std::endl;
+    std::cout << std::endl;
+  }
+  std::cout << "Wall time: " << wallTime.count() << " s ("
+            << trace.size() / wallTime.count() << " records/s)" << std::endl;
+  return 0;
+}
@@ -0,0 +1,142 @@
+#include "Modes.h"
+
+#include "AbstractTF/BranchAndBound.h"
+#include "AbstractTF/Compare.h"
+#include "AbstractTF/Parallel.h"
+#include "AbstractTF/SatMulhs.h"
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+
+using llvm::APInt;
+using llvm::KnownBits;
+using namespace abstracttf;
+
+namespace {
+struct SatSpotCheck {
+  bool exact = false;
+  bool bnbExact = false;
+  bool bnbAgrees = false;
+  PrecisionOrder order = PrecisionOrder::Same;
+  double timeComposite = 0.0;
+  double timeSat = 0.0;
+  unsigned queries = 0;
+};
+} // namespace
+
+// Each bit is unknown, zero or one with equal probability
+static KnownBits randomKnownBits(unsigned bw, std::mt19937_64 &rng) {
+  KnownBits kb(bw);
+  for (unsigned i = 0; i < bw; i++) {
+    switch (rng() % 3) {
+    case 0:
+      kb.Zero.setBit(i);
+      break;
+    case 1:
+      kb.One.setBit(i);
+      break;
+    }
+  }
+  return kb;
+}
+
+int runSatMode(unsigned bitWidth, uint64_t count, uint64_t seed,
+               unsigned numThreads) {
+  // Queries are generated up front so the batch is independent of the
+  // thread count
+  std::mt19937_64 rng(seed);
+  std::vector<std::pair<KnownBits, KnownBits>> queries;
+  for (uint64_t i = 0; i < count; i++) {
+    KnownBits lhs = randomKnownBits(bitWidth, rng);
+    queries.emplace_back(lhs, randomKnownBits(bitWidth, rng));
+  }
+
+  // One oracle per thread; each is reused for every query that thread runs
+  std::vector<std::unique_ptr<SatMulhsOracle>> oracles(numThreads);
+  std::vector<SatSpotCheck> checks(count);
+  parallelFor(count, numThreads, [&](size_t i, unsigned thread) {
+    if (!oracles[thread])
+      oracles[thread] = std::make_unique<SatMulhsOracle>(bitWidth);
+    const KnownBits &lhs = queries[i].first;
+    const KnownBits &rhs = queries[i].second;
+    SatSpotCheck &check = checks[i];
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+    KnownBits composite = KnownBits::mulhs(lhs, rhs);
+    auto t2 = std::chrono::high_resolution_clock::now();
+    check.timeComposite = (t2 - t1).count();
+
+    t1 = std::chrono::high_resolution_clock::now();
+    SatMulhsOracle::Result sat = oracles[thread]->compute(lhs, rhs);
+    t2 = std::chrono::high_resolution_clock::now();
+    check.timeSat = (t2 - t1).count();
+    check.exact = sat.exact;
+    check.queries = sat.queries;
+    check.order = comparePrecision(composite, sat.result);
+
+    // Cross-check against the branch-and-bound oracle where it applies
+    if (sat.exact && bitWidth <= 64) {
+      BranchAndBoundResult bnb = branchAndBoundMulhs(lhs, rhs);
+      check.bnbExact = bnb.exact;
+      check.bnbAgrees = bnb.exact && bnb.result.Zero == sat.result.Zero &&
+                        bnb.result.One == sat.result.One;
+    }
+  });
+
+  uint64_t exact = 0, bnbCompared = 0, bnbDisagree = 0, queriesTotal = 0;
+  double totalTimeComposite = 0.0, totalTimeSat = 0.0;
+  PrecisionCounts counts;
+  for (const SatSpotCheck &check : checks) {
+    totalTimeComposite += check.timeComposite;
+    totalTimeSat += check.timeSat;
+    queriesTotal += check.queries;
+    if (!check.exact)
+      continue;
+    exact++;
+    counts.add(check.order);
+    if (check.bnbExact) {
+      bnbCompared++;
+      bnbDisagree += !check.bnbAgrees;
+    }
+  }
+
+  uint64_t conflicts = 0;
+  unsigned vars = 0, clauses = 0;
+  for (const std::unique_ptr<SatMulhsOracle> &oracle : oracles) {
+    if (!oracle)
+      continue;
+    conflicts += oracle->getSolver().conflicts();
+    vars = oracle->getSolver().numVars();
+    clauses = oracle->getSolver().numClauses();
+  }
+
+  std::cout << "SAT spot-check of mulhs for BitWidth = " << bitWidth
+            << std::endl;
+  std::cout << "Circuit: " << vars << " variables, " << clauses << " clauses"
+            << std::endl;
+  std::cout << "Random pairs: " << count << " (seed " << seed << ")"
+            << std::endl;
+  std::cout << "Decided exactly: " << exact << " (" << count - exact
+            << " hit the conflict limit)" << std::endl;
+  std::cout << "Composite transfer function more precise: "
+            << counts.compositeMorePrecise << std::endl;
+  std::cout << "SAT oracle more precise: " << counts.naiveMorePrecise
+            << std::endl;
+  std::cout << "Same precision for both transfer functions: "
+            << counts.samePrecision << std::endl;
+  std::cout << "Incomparable results: " << counts.incomparableResults
+            << std::endl;
+  if (bitWidth <= 64)
+    std::cout << "Branch-and-bound cross-checks: " << bnbCompared << " ("
+              << bnbDisagree << " disagreements)" << std::endl;
+  std::cout << "Solver calls per pair: " << double(queriesTotal) / count
+            << ", conflicts: " << conflicts << std::endl;
+  std::cout << "Average composite time: " << totalTimeComposite / count
+            << std::endl;
+  std::cout << "Average SAT oracle time: " << totalTimeSat / count
+            << std::endl;
+
+  return bnbDisagree || counts.incomparableResults ? 1 : 0;
+}
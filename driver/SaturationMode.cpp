@@ -0,0 +1,31 @@
+#include "Modes.h"
+
+#include "AbstractTF/Progress.h"
+#include "AbstractTF/SaturationSweep.h"
+
+#include <chrono>
+#include <iostream>
+
+using namespace abstracttf;
+
+int runSaturationMode(unsigned bitWidth, unsigned numThreads,
+                      std::chrono::seconds progressInterval) {
+  SaturationSweepFn sweep = getSaturationSweep(bitWidth);
+  if (!sweep) {
+    std::cerr << "--saturation supports bit widths 1-" << MaxFixedBitWidth
+              << std::endl;
+    return 1;
+  }
+
+  uint64_t totalKnownBits = numKnownBits(bitWidth);
+  ProgressReporter progress("saturation bw=" + std::to_string(bitWidth),
+                            totalKnownBits * totalKnownBits, numThreads,
+                            progressInterval, std::cerr);
+  SweepOptions options;
+  options.numThreads = numThreads;
+  options.progress = &progress;
+
+  SaturationSweepResult result = sweep(options);
+  printSaturationSweepResult(std::cout, result);
+  return result.mismatches ? 1 : 0;
+}
@@ -0,0 +1,172 @@
+#include "Modes.h"
+
+#include "AbstractTF/Format.h"
+#include "AbstractTF/OracleTable.h"
+#include "AbstractTF/PairStream.h"
+#include "AbstractTF/Parallel.h"
+#include "AbstractTF/QueryProtocol.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <thread>
+#include <unistd.h>
+
+using namespace abstracttf;
+
+namespace {
+// Records evaluated per parallel work item within one batch
+constexpr size_t StreamChunkSize = 256;
+
+enum StreamVerdict { Optimal, Imprecise, Unsound, Undecided, NumVerdicts };
+
+const char *const VerdictNames[NumVerdicts] = {"optimal", "imprecise",
+                                               "unsound", "undecided"};
+
+struct StreamBatch {
+  std::vector<TraceRecord> records;
+  std::vector<QueryResult> results;
+};
+} // namespace
+
+// Parses up to `batchSize` pairs into `batch`. Returns false on a malformed
+// line, keeping the pairs before it; an empty batch marks the end of the
+// input.
+static bool readBatch(PairReader &reader, size_t batchSize,
+                      StreamBatch &batch, std::string &error) {
+  batch.records.clear();
+  llvm::StringRef lhsText, rhsText;
+  KnownBits lhs, rhs;
+  while (batch.records.size() < batchSize && reader.next(lhsText, rhsText)) {
+    if (!parseKnownBits(lhsText, lhs) || !parseKnownBits(rhsText, rhs) ||
+        lhs.getBitWidth() != rhs.getBitWidth() ||
+        lhs.getBitWidth() > MaxTraceBitWidth) {
+      error = "line " + std::to_string(reader.lineNumber()) +
+              ": expected two operands of the same width up to " +
+              std::to_string(MaxTraceBitWidth) + " bits";
+      return false;
+    }
+    batch.records.push_back(TraceRecord::make(TraceOp::Mulhs, lhs, rhs));
+  }
+  error = reader.error();
+  return error.empty();
+}
+
+static void evaluateBatch(StreamBatch &batch,
+                          const std::vector<OracleTable> &tables,
+                          unsigned numThreads) {
+  batch.results.resize(batch.records.size());
+  size_t numChunks =
+      (batch.records.size() + StreamChunkSize - 1) / StreamChunkSize;
+  parallelFor(numChunks, numThreads, [&](size_t chunk, unsigned) {
+    size_t end = std::min(batch.records.size(), (chunk + 1) * StreamChunkSize);
+    for (size_t i = chunk * StreamChunkSize; i < end; i++)
+      batch.results[i] = answerMulhsQuery(batch.records[i], tables);
+  });
+}
+
+static StreamVerdict verdictOf(const QueryResult &result) {
+  if (result.status == static_cast<uint8_t>(QueryStatus::Undecided))
+    return Undecided;
+  if (result.compositeZero == result.optimalZero &&
+      result.compositeOne == result.optimalOne)
+    return Optimal;
+  // The optimal result is the most precise sound one
+  bool subset = (result.compositeZero & ~result.optimalZero) == 0 &&
+                (result.compositeOne & ~result.optimalOne) == 0;
+  return subset ? Imprecise : Unsound;
+}
+
+// Appends the Format.h text of (zero, one) without going through APInt
+static void appendKnownBits(std::string &out, unsigned bitWidth,
+                            uint64_t zero, uint64_t one) {
+  for (unsigned i = bitWidth; i-- > 0;)
+    out += zero >> i & 1 ? '0' : one >> i & 1 ? '1' : '?';
+}
+
+int runStreamMode(const std::string &inputPath, size_t batchSize,
+                  unsigned tableWidth, const std::string &tableDir,
+                  unsigned numThreads, std::chrono::seconds progressInterval) {
+  if (tableWidth > MaxOracleTableBitWidth) {
+    std::cerr << "--tables supports bit widths 0-" << MaxOracleTableBitWidth
+              << std::endl;
+    return 1;
+  }
+  int fd = inputPath == "-" ? STDIN_FILENO
+                            : ::open(inputPath.c_str(), O_RDONLY);
+  if (fd < 0) {
+    std::cerr << inputPath << ": " << std::strerror(errno) << std::endl;
+    return 1;
+  }
+  std::vector<OracleTable> tables;
+  if (!loadOracleTables(tableWidth, tableDir, numThreads, progressInterval,
+                        std::cerr, tables))
+    return 1;
+
+  // While the workers evaluate one batch, this thread parses the next one
+  // and then writes the finished one out, so at most two batches are held.
+  batchSize = std::max<size_t>(1, batchSize);
+  PairReader reader(fd);
+  StreamBatch batches[2];
+  std::string error;
+  std::string out;
+  uint64_t pairs = 0, numBatches = 0;
+  uint64_t verdicts[NumVerdicts] = {};
+  auto wallStart = std::chrono::steady_clock::now();
+  bool ok = readBatch(reader, batchSize, batches[0], error);
+  for (unsigned current = 0; !batches[current].records.empty();
+       current ^= 1) {
+    StreamBatch &batch = batches[current];
+    std::thread evaluator(evaluateBatch, std::ref(batch), std::cref(tables),
+                          numThreads);
+    batches[current ^ 1].records.clear();
+    if (ok)
+      ok = readBatch(reader, batchSize, batches[current ^ 1], error);
+    evaluator.join();
+
+    out.clear();
+    for (size_t i = 0; i < batch.records.size(); i++) {
+      const TraceRecord &record = batch.records[i];
+      const QueryResult &result = batch.results[i];
+      StreamVerdict verdict = verdictOf(result);
+      verdicts[verdict]++;
+      appendKnownBits(out, record.bitWidth, record.lhsZero, record.lhsOne);
+      out += ' ';
+      appendKnownBits(out, record.bitWidth, record.rhsZero, record.rhsOne);
+      out += ' ';
+      appendKnownBits(out, result.bitWidth, result.compositeZero,
+                      result.compositeOne);
+      out += ' ';
+      appendKnownBits(out, result.bitWidth, result.optimalZero,
+                      result.optimalOne);
+      out += ' ';
+      out += VerdictNames[verdict];
+      out += '\n';
+    }
+    std::fwrite(out.data(), 1, out.size(), stdout);
+    pairs += batch.records.size();
+    numBatches++;
+  }
+  std::fflush(stdout);
+  std::chrono::duration<double> wallTime =
+      std::chrono::steady_clock::now() - wallStart;
+  if (fd != STDIN_FILENO)
+    ::close(fd);
+  if (!ok) {
+    std::cerr << inputPath << ": " << error << std::endl;
+    return 1;
+  }
+
+  std::cerr << "Streamed " << pairs << " pairs in " << numBatches
+            << " batches of up to " << batchSize << " on " << numThreads
+            << " threads" << std::endl;
+  for (unsigned verdict = 0; verdict < NumVerdicts; verdict++)
+    std::cerr << "  " << VerdictNames[verdict] << ": " << verdicts[verdict]
+              << std::endl;
+  std::cerr << "Wall time: " << wallTime.count() << " s ("
+            << pairs / wallTime.count() << " pairs/s)" << std::endl;
+  return 0;
+}
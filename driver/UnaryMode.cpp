@@ -0,0 +1,50 @@
+#include "Modes.h"
+
+#include "AbstractTF/Progress.h"
+#include "AbstractTF/UnarySweep.h"
+
+#include <chrono>
+#include <iostream>
+
+using namespace abstracttf;
+
+int runUnaryMode(const std::vector<UnaryOp> &requested, unsigned bitWidth,
+                 unsigned numThreads, std::chrono::seconds progressInterval) {
+  UnarySweepFn sweep = getUnaryFixedWidthSweep(bitWidth);
+  if (!sweep) {
+    std::cerr << "--unary supports bit widths 1-" << MaxFixedBitWidth
+              << std::endl;
+    return 1;
+  }
+
+  std::vector<UnaryOp> ops;
+  for (UnaryOp op : requested) {
+    if (unaryOpSupported(op, bitWidth))
+      ops.push_back(op);
+    else
+      std::cerr << "Skipping " << unaryOpName(op) << ": not valid at i"
+                << bitWidth << std::endl;
+  }
+  if (ops.empty())
+    return 1;
+
+  uint64_t total = numKnownBits(bitWidth);
+  ProgressReporter progress(std::to_string(ops.size()) + " unary ops bw=" +
+                                std::to_string(bitWidth),
+                            total * ops.size(), numThreads, progressInterval,
+                            std::cerr);
+  SweepOptions options;
+  options.numThreads = numThreads;
+  options.progress = &progress;
+
+  auto wallStart = std::chrono::steady_clock::now();
+  std::vector<SweepResult> results = sweep(ops, options);
+  std::chrono::duration<double> wallTime =
+      std::chrono::steady_clock::now() - wallStart;
+
+  for (size_t k = 0; k < ops.size(); k++)
+    printSweepResult(std::cout, unaryOpName(ops[k]), results[k]);
+  std::cout << "Wall time for " << ops.size()
+            << " operators: " << wallTime.count() << " s" << std::endl;
+  return 0;
+}
@@ -0,0 +1,40 @@
+// Abstraction (alpha) of a set of integers into the most precise KnownBits
+// value that describes all of them.
+
+#ifndef ABSTRACTTF_ABSTRACTION_H
+#define ABSTRACTTF_ABSTRACTION_H
+
+#include <cassert>
+#include <llvm/ADT/APInt.h>
+#include <llvm/Support/KnownBits.h>
+#include <vector>
+
+namespace abstracttf {
+
+using llvm::APInt;
+using llvm::KnownBits;
+
+inline KnownBits abstraction(const std::vector<APInt> &values) {
+  assert(!values.empty() && "Values set should not be empty");
+  unsigned bw = values.begin()->getBitWidth();
+
+  APInt knownZero = APInt::getAllOnes(bw);
+  APInt knownOne = APInt::getAllOnes(bw);
+
+  for (const APInt &value : values) {
+    assert(value.getBitWidth() == bw &&
+           "All values must have the same bitwidth");
+    knownZero &= ~value;
+    knownOne &= value;
+  }
+
+  KnownBits kb(bw);
+  kb.Zero = knownZero;
+  kb.One = knownOne;
+
+  return kb;
+}
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_ABSTRACTION_H
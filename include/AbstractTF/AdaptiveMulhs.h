@@ -0,0 +1,38 @@
+// Hybrid mulhs transfer function for use inside a compiler: exact when the
+// operands have few unknown bits, LLVM's composite otherwise.
+
+#ifndef ABSTRACTTF_ADAPTIVEMULHS_H
+#define ABSTRACTTF_ADAPTIVEMULHS_H
+
+#include "AbstractTF/Compare.h"
+#include "AbstractTF/MulhsOracle.h"
+
+#include <cstdint>
+#include <llvm/Support/KnownBits.h>
+
+namespace abstracttf {
+
+using llvm::KnownBits;
+
+// Maximum number of concrete products, 2^(k_lhs + k_rhs), that
+// adaptiveMulhs enumerates before falling back to the composite.
+constexpr uint64_t DefaultAdaptiveThreshold = uint64_t(1) << 8;
+
+inline bool adaptiveMulhsEnumerates(const KnownBits &lhs, const KnownBits &rhs,
+                                    uint64_t threshold) {
+  unsigned unknowns = unknownBitCount(lhs) + unknownBitCount(rhs);
+  return unknowns < 64 && (uint64_t(1) << unknowns) < threshold;
+}
+
+// Strictly at least as precise as KnownBits::mulhs: enumeration gives the
+// optimal result, and the fallback is the composite itself.
+inline KnownBits adaptiveMulhs(const KnownBits &lhs, const KnownBits &rhs,
+                               uint64_t threshold = DefaultAdaptiveThreshold) {
+  if (adaptiveMulhsEnumerates(lhs, rhs, threshold))
+    return exactMulhs(lhs, rhs);
+  return KnownBits::mulhs(lhs, rhs);
+}
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_ADAPTIVEMULHS_H
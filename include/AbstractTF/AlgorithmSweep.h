@@ -0,0 +1,182 @@
+// Head-to-head sweep of the mulhs algorithms in MulhsAlgorithms.h.
+//
+// Every pair of one width is run through each algorithm and compared with
+// the optimal result and with LLVM's. The report is one table row per
+// algorithm: how often it is optimal or unsound (judged on the masks, see
+// classifyResult), how many bits it knows on average, how often it beats
+// or loses to KnownBits::mulhs, and its average latency.
+
+#ifndef ABSTRACTTF_ALGORITHMSWEEP_H
+#define ABSTRACTTF_ALGORITHMSWEEP_H
+
+#include "AbstractTF/Compare.h"
+#include "AbstractTF/FixedWidth.h"
+#include "AbstractTF/MulhsAlgorithms.h"
+#include "AbstractTF/Parallel.h"
+#include "AbstractTF/Progress.h"
+#include "AbstractTF/Sweep.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <llvm/Support/KnownBits.h>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace abstracttf {
+
+using llvm::KnownBits;
+
+struct AlgorithmStats {
+  // Against the optimal result, by classifyResult
+  uint64_t optimal = 0;
+  uint64_t imprecise = 0;
+  uint64_t unsound = 0;
+  uint64_t knownBits = 0;
+  uint64_t betterThanLLVM = 0;
+  uint64_t worseThanLLVM = 0;
+  double totalTime = 0.0; // nanoseconds
+
+  AlgorithmStats &operator+=(const AlgorithmStats &other) {
+    optimal += other.optimal;
+    imprecise += other.imprecise;
+    unsound += other.unsound;
+    knownBits += other.knownBits;
+    betterThanLLVM += other.betterThanLLVM;
+    worseThanLLVM += other.worseThanLLVM;
+    totalTime += other.totalTime;
+    return *this;
+  }
+};
+
+struct AlgorithmSweepResult {
+  unsigned bitWidth = 0;
+  uint64_t totalPairs = 0;
+  uint64_t optimalKnownBits = 0;
+  // One entry per AllMulhsAlgorithms entry
+  std::vector<AlgorithmStats> algorithms;
+};
+
+template <unsigned BW>
+inline AlgorithmSweepResult sweepMulhsAlgorithms(const SweepOptions &options) {
+  constexpr size_t NumAlgorithms = std::size(AllMulhsAlgorithms);
+  std::vector<FixedKnownBits<BW>> allFixed = enumerateFixedWidth<BW>();
+  std::vector<KnownBits> allKnownBits;
+  allKnownBits.reserve(allFixed.size());
+  for (const FixedKnownBits<BW> &kb : allFixed)
+    allKnownBits.push_back(kb.toKnownBits());
+
+  unsigned numThreads = std::max(1u, options.numThreads);
+  SweepCounters threadCounters(options);
+  std::vector<AlgorithmSweepResult> partials(numThreads);
+  for (AlgorithmSweepResult &partial : partials)
+    partial.algorithms.resize(NumAlgorithms);
+
+  auto rowCost = [&](size_t i) {
+    return pairRowCost(__builtin_popcount(allFixed[i].unknown()));
+  };
+  parallelForByCost(
+      allFixed.size(), numThreads, rowCost,
+      [&](size_t i, unsigned thread) {
+        WorkerCounters &counters = threadCounters[thread];
+        AlgorithmSweepResult &partial = partials[thread];
+        for (size_t j = 0; j < allFixed.size(); j++) {
+          FixedKnownBits<BW> optimal =
+              fixedNaiveMulhs(allFixed[i], allFixed[j]);
+          partial.optimalKnownBits +=
+              __builtin_popcount(optimal.Zero | optimal.One);
+          FixedKnownBits<BW> llvmResult;
+          for (size_t k = 0; k < NumAlgorithms; k++) {
+            AlgorithmStats &stats = partial.algorithms[k];
+            auto t1 = std::chrono::high_resolution_clock::now();
+            KnownBits result =
+                AllMulhsAlgorithms[k].fn(allKnownBits[i], allKnownBits[j]);
+            auto t2 = std::chrono::high_resolution_clock::now();
+            stats.totalTime += (t2 - t1).count();
+
+            FixedKnownBits<BW> fixed =
+                FixedKnownBits<BW>::fromKnownBits(result);
+            if (k == 0)
+              llvmResult = fixed;
+            switch (classifyResult(fixed, optimal)) {
+            case ResultVerdict::Optimal:
+              stats.optimal++;
+              break;
+            case ResultVerdict::Imprecise:
+              stats.imprecise++;
+              break;
+            case ResultVerdict::Unsound:
+              stats.unsound++;
+              break;
+            }
+            stats.knownBits += __builtin_popcount(fixed.Zero | fixed.One);
+            PrecisionOrder vsLLVM = comparePrecision(fixed, llvmResult);
+            stats.betterThanLLVM += vsLLVM == PrecisionOrder::FirstMorePrecise;
+            stats.worseThanLLVM += vsLLVM == PrecisionOrder::SecondMorePrecise;
+          }
+          counters.add(PrecisionOrder::Same);
+        }
+      },
+      options.schedule);
+
+  AlgorithmSweepResult result;
+  result.bitWidth = BW;
+  result.totalPairs = uint64_t(allFixed.size()) * allFixed.size();
+  result.algorithms.resize(NumAlgorithms);
+  for (const AlgorithmSweepResult &partial : partials) {
+    result.optimalKnownBits += partial.optimalKnownBits;
+    for (size_t k = 0; k < NumAlgorithms; k++)
+      result.algorithms[k] += partial.algorithms[k];
+  }
+  return result;
+}
+
+using AlgorithmSweepFn = AlgorithmSweepResult (*)(const SweepOptions &);
+
+template <size_t... Is>
+constexpr std::array<AlgorithmSweepFn, sizeof...(Is) + 1>
+makeAlgorithmSweepTable(std::index_sequence<Is...>) {
+  return {nullptr, &sweepMulhsAlgorithms<Is + 1>...};
+}
+
+// Returns the algorithm sweep for `bitWidth`, or nullptr if the width has
+// no fixed-width kernels.
+inline AlgorithmSweepFn getAlgorithmSweep(unsigned bitWidth) {
+  static constexpr std::array<AlgorithmSweepFn, MaxFixedBitWidth + 1> Table =
+      makeAlgorithmSweepTable(std::make_index_sequence<MaxFixedBitWidth>());
+  if (bitWidth == 0 || bitWidth > MaxFixedBitWidth)
+    return nullptr;
+  return Table[bitWidth];
+}
+
+inline void printAlgorithmSweepResult(std::ostream &os,
+                                      const AlgorithmSweepResult &result) {
+  double pairs = result.totalPairs;
+  os << "Comparing mulhs algorithms for BitWidth = " << result.bitWidth
+     << std::endl;
+  os << "Average known bits of the optimal result: "
+     << result.optimalKnownBits / pairs << std::endl;
+  os << std::setw(12) << "Algorithm" << std::setw(10) << "Optimal"
+     << std::setw(10) << "Unsound" << std::setw(12) << "Known bits"
+     << std::setw(12) << "vs llvm +" << std::setw(12) << "vs llvm -"
+     << std::setw(12) << "Avg ns" << std::endl;
+  for (size_t k = 0; k < result.algorithms.size(); k++) {
+    const AlgorithmStats &stats = result.algorithms[k];
+    os << std::setw(12) << AllMulhsAlgorithms[k].name << std::fixed
+       << std::setprecision(2) << std::setw(9)
+       << 100.0 * stats.optimal / pairs << "%" << std::setw(10)
+       << stats.unsound << std::setw(12)
+       << stats.knownBits / pairs << std::setw(12) << stats.betterThanLLVM
+       << std::setw(12) << stats.worseThanLLVM << std::setw(12)
+       << stats.totalTime / pairs << std::endl;
+    os.unsetf(std::ios::floatfield);
+    os << std::setprecision(6);
+  }
+  os << std::endl;
+}
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_ALGORITHMSWEEP_H
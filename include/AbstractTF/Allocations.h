@@ -0,0 +1,73 @@
+// Heap allocation accounting for transfer-function calls.
+//
+// When built with ABSTRACTTF_COUNT_ALLOCATIONS, lib/AllocationCounter.cpp
+// replaces the global operator new/delete and charges every allocation made
+// on a thread to that thread's active AllocationScope, if any. Without the
+// option the scopes compile to nothing and all counts stay zero.
+
+#ifndef ABSTRACTTF_ALLOCATIONS_H
+#define ABSTRACTTF_ALLOCATIONS_H
+
+#include <cstdint>
+#include <ostream>
+
+namespace abstracttf {
+
+struct AllocationCounts {
+  uint64_t allocations = 0;
+  uint64_t bytes = 0;
+
+  AllocationCounts &operator+=(const AllocationCounts &other) {
+    allocations += other.allocations;
+    bytes += other.bytes;
+    return *this;
+  }
+};
+
+#ifdef ABSTRACTTF_COUNT_ALLOCATIONS
+inline constexpr bool AllocationCountingEnabled = true;
+
+// Where operator new charges allocations made on this thread; null outside
+// of any scope.
+inline thread_local AllocationCounts *CurrentAllocationCounts = nullptr;
+
+// Charge allocations on this thread to `counts` for the lifetime of the
+// scope. Scopes nest; the innermost one wins.
+class AllocationScope {
+public:
+  explicit AllocationScope(AllocationCounts &counts)
+      : previous(CurrentAllocationCounts) {
+    CurrentAllocationCounts = &counts;
+  }
+  ~AllocationScope() { CurrentAllocationCounts = previous; }
+
+  AllocationScope(const AllocationScope &) = delete;
+  AllocationScope &operator=(const AllocationScope &) = delete;
+
+private:
+  AllocationCounts *previous;
+};
+#else
+inline constexpr bool AllocationCountingEnabled = false;
+
+class AllocationScope {
+public:
+  explicit AllocationScope(AllocationCounts &) {}
+};
+#endif
+
+// Print average allocations and bytes per call for both implementations
+inline void printAllocationsPerCall(std::ostream &os,
+                                    const AllocationCounts &composite,
+                                    const AllocationCounts &naive,
+                                    uint64_t calls) {
+  os << "Average composite allocations: "
+     << double(composite.allocations) / calls << " ("
+     << double(composite.bytes) / calls << " bytes)" << std::endl;
+  os << "Average naive allocations: " << double(naive.allocations) / calls
+     << " (" << double(naive.bytes) / calls << " bytes)" << std::endl;
+}
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_ALLOCATIONS_H
@@ -0,0 +1,267 @@
+// Binary operators with a KnownBits transfer function in LLVM, paired with
+// their concrete semantics on the fixed-width kernels.
+//
+// Concrete operations return false when the result is undefined (poison or
+// immediate UB in LLVM IR: zero divisors, signed division overflow,
+// over-wide shift amounts). Oracles skip those concretizations.
+
+#ifndef ABSTRACTTF_BINARYOPS_H
+#define ABSTRACTTF_BINARYOPS_H
+
+#include "AbstractTF/FixedWidth.h"
+
+#include <cstdint>
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/Optional.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/ErrorHandling.h>
+#include <llvm/Support/KnownBits.h>
+#include <type_traits>
+
+namespace abstracttf {
+
+using llvm::KnownBits;
+
+enum class BinaryOp : uint8_t {
+  Mulhs,
+  Mulhu,
+  Mul,
+  Add,
+  Sub,
+  And,
+  Or,
+  Xor,
+  UMax,
+  UMin,
+  SMax,
+  SMin,
+  UDiv,
+  URem,
+  SRem,
+  Shl,
+  LShr,
+  AShr,
+};
+
+constexpr BinaryOp AllBinaryOps[] = {
+    BinaryOp::Mulhs, BinaryOp::Mulhu, BinaryOp::Mul,  BinaryOp::Add,
+    BinaryOp::Sub,   BinaryOp::And,   BinaryOp::Or,   BinaryOp::Xor,
+    BinaryOp::UMax,  BinaryOp::UMin,  BinaryOp::SMax, BinaryOp::SMin,
+    BinaryOp::UDiv,  BinaryOp::URem,  BinaryOp::SRem, BinaryOp::Shl,
+    BinaryOp::LShr,  BinaryOp::AShr,
+};
+
+inline const char *binaryOpName(BinaryOp op) {
+  switch (op) {
+  case BinaryOp::Mulhs:
+    return "mulhs";
+  case BinaryOp::Mulhu:
+    return "mulhu";
+  case BinaryOp::Mul:
+    return "mul";
+  case BinaryOp::Add:
+    return "add";
+  case BinaryOp::Sub:
+    return "sub";
+  case BinaryOp::And:
+    return "and";
+  case BinaryOp::Or:
+    return "or";
+  case BinaryOp::Xor:
+    return "xor";
+  case BinaryOp::UMax:
+    return "umax";
+  case BinaryOp::UMin:
+    return "umin";
+  case BinaryOp::SMax:
+    return "smax";
+  case BinaryOp::SMin:
+    return "smin";
+  case BinaryOp::UDiv:
+    return "udiv";
+  case BinaryOp::URem:
+    return "urem";
+  case BinaryOp::SRem:
+    return "srem";
+  case BinaryOp::Shl:
+    return "shl";
+  case BinaryOp::LShr:
+    return "lshr";
+  case BinaryOp::AShr:
+    return "ashr";
+  }
+  llvm_unreachable("Unknown binary op");
+}
+
+inline llvm::Optional<BinaryOp> parseBinaryOp(llvm::StringRef name) {
+  for (BinaryOp op : AllBinaryOps)
+    if (name == binaryOpName(op))
+      return op;
+  return llvm::None;
+}
+
+// LLVM's transfer function for `op`
+inline KnownBits compositeBinaryOp(BinaryOp op, const KnownBits &lhs,
+                                   const KnownBits &rhs) {
+  switch (op) {
+  case BinaryOp::Mulhs:
+    return KnownBits::mulhs(lhs, rhs);
+  case BinaryOp::Mulhu:
+    return KnownBits::mulhu(lhs, rhs);
+  case BinaryOp::Mul:
+    return KnownBits::mul(lhs, rhs);
+  case BinaryOp::Add:
+    return KnownBits::computeForAddSub(/*Add=*/true, /*NSW=*/false, lhs, rhs);
+  case BinaryOp::Sub:
+    return KnownBits::computeForAddSub(/*Add=*/false, /*NSW=*/false, lhs, rhs);
+  case BinaryOp::And:
+    return lhs & rhs;
+  case BinaryOp::Or:
+    return lhs | rhs;
+  case BinaryOp::Xor:
+    return lhs ^ rhs;
+  case BinaryOp::UMax:
+    return KnownBits::umax(lhs, rhs);
+  case BinaryOp::UMin:
+    return KnownBits::umin(lhs, rhs);
+  case BinaryOp::SMax:
+    return KnownBits::smax(lhs, rhs);
+  case BinaryOp::SMin:
+    return KnownBits::smin(lhs, rhs);
+  case BinaryOp::UDiv:
+    return KnownBits::udiv(lhs, rhs);
+  case BinaryOp::URem:
+    return KnownBits::urem(lhs, rhs);
+  case BinaryOp::SRem:
+    return KnownBits::srem(lhs, rhs);
+  case BinaryOp::Shl:
+    return KnownBits::shl(lhs, rhs);
+  case BinaryOp::LShr:
+    return KnownBits::lshr(lhs, rhs);
+  case BinaryOp::AShr:
+    return KnownBits::ashr(lhs, rhs);
+  }
+  llvm_unreachable("Unknown binary op");
+}
+
+// Concrete semantics of `Op` on BW-bit values. Returns false if the result
+// is undefined.
+template <unsigned BW, BinaryOp Op>
+inline bool fixedConcreteBinaryOp(uint32_t lhs, uint32_t rhs, uint32_t &out) {
+  constexpr uint32_t Mask = FixedKnownBits<BW>::Mask;
+  constexpr uint32_t SignBit = FixedKnownBits<BW>::SignBit;
+  if constexpr (Op == BinaryOp::Mulhs) {
+    out = fixedConcreteMulhs<BW>(lhs, rhs);
+  } else if constexpr (Op == BinaryOp::Mulhu) {
+    out = uint32_t((uint64_t(lhs) * rhs) >> BW) & Mask;
+  } else if constexpr (Op == BinaryOp::Mul) {
+    out = (lhs * rhs) & Mask;
+  } else if constexpr (Op == BinaryOp::Add) {
+    out = (lhs + rhs) & Mask;
+  } else if constexpr (Op == BinaryOp::Sub) {
+    out = (lhs - rhs) & Mask;
+  } else if constexpr (Op == BinaryOp::And) {
+    out = lhs & rhs;
+  } else if constexpr (Op == BinaryOp::Or) {
+    out = lhs | rhs;
+  } else if constexpr (Op == BinaryOp::Xor) {
+    out = lhs ^ rhs;
+  } else if constexpr (Op == BinaryOp::UMax) {
+    out = lhs > rhs ? lhs : rhs;
+  } else if constexpr (Op == BinaryOp::UMin) {
+    out = lhs < rhs ? lhs : rhs;
+  } else if constexpr (Op == BinaryOp::SMax) {
+    out = fixedSext<BW>(lhs) > fixedSext<BW>(rhs) ? lhs : rhs;
+  } else if constexpr (Op == BinaryOp::SMin) {
+    out = fixedSext<BW>(lhs) < fixedSext<BW>(rhs) ? lhs : rhs;
+  } else if constexpr (Op == BinaryOp::UDiv) {
+    if (rhs == 0)
+      return false;
+    out = lhs / rhs;
+  } else if constexpr (Op == BinaryOp::URem) {
+    if (rhs == 0)
+      return false;
+    out = lhs % rhs;
+  } else if constexpr (Op == BinaryOp::SRem) {
+    if (rhs == 0 || (lhs == SignBit && rhs == Mask))
+      return false;
+    out = uint32_t(fixedSext<BW>(lhs) % fixedSext<BW>(rhs)) & Mask;
+  } else if constexpr (Op == BinaryOp::Shl) {
+    if (rhs >= BW)
+      return false;
+    out = (lhs << rhs) & Mask;
+  } else if constexpr (Op == BinaryOp::LShr) {
+    if (rhs >= BW)
+      return false;
+    out = lhs >> rhs;
+  } else if constexpr (Op == BinaryOp::AShr) {
+    if (rhs >= BW)
+      return false;
+    out = uint32_t(fixedSext<BW>(lhs) >> rhs) & Mask;
+  } else {
+    static_assert(Op != Op, "Missing concrete semantics");
+  }
+  return true;
+}
+
+// Call `fn(std::integral_constant<BinaryOp, Op>())` for the runtime `op`, so
+// `fn` can instantiate its inner loop on a compile-time operator.
+template <typename Fn> inline void withBinaryOp(BinaryOp op, Fn &&fn) {
+#define ABSTRACTTF_BINARY_OP_CASE(NAME)                                        \
+  case BinaryOp::NAME:                                                         \
+    return fn(std::integral_constant<BinaryOp, BinaryOp::NAME>());
+  switch (op) {
+    ABSTRACTTF_BINARY_OP_CASE(Mulhs)
+    ABSTRACTTF_BINARY_OP_CASE(Mulhu)
+    ABSTRACTTF_BINARY_OP_CASE(Mul)
+    ABSTRACTTF_BINARY_OP_CASE(Add)
+    ABSTRACTTF_BINARY_OP_CASE(Sub)
+    ABSTRACTTF_BINARY_OP_CASE(And)
+    ABSTRACTTF_BINARY_OP_CASE(Or)
+    ABSTRACTTF_BINARY_OP_CASE(Xor)
+    ABSTRACTTF_BINARY_OP_CASE(UMax)
+    ABSTRACTTF_BINARY_OP_CASE(UMin)
+    ABSTRACTTF_BINARY_OP_CASE(SMax)
+    ABSTRACTTF_BINARY_OP_CASE(SMin)
+    ABSTRACTTF_BINARY_OP_CASE(UDiv)
+    ABSTRACTTF_BINARY_OP_CASE(URem)
+    ABSTRACTTF_BINARY_OP_CASE(SRem)
+    ABSTRACTTF_BINARY_OP_CASE(Shl)
+    ABSTRACTTF_BINARY_OP_CASE(LShr)
+    ABSTRACTTF_BINARY_OP_CASE(AShr)
+  }
+#undef ABSTRACTTF_BINARY_OP_CASE
+  llvm_unreachable("Unknown binary op");
+}
+
+// Optimal transfer function for `Op` over pre-concretized operands. Returns
+// None when no pair of concrete values has a defined result.
+template <unsigned BW, BinaryOp Op>
+inline llvm::Optional<FixedKnownBits<BW>>
+fixedOptimalBinaryOp(llvm::ArrayRef<uint32_t> lhsValues,
+                     llvm::ArrayRef<uint32_t> rhsValues) {
+  constexpr uint32_t Mask = FixedKnownBits<BW>::Mask;
+  uint32_t knownZero = Mask;
+  uint32_t knownOne = Mask;
+  bool defined = false;
+  for (uint32_t cLhs : lhsValues) {
+    for (uint32_t cRhs : rhsValues) {
+      uint32_t value;
+      if (!fixedConcreteBinaryOp<BW, Op>(cLhs, cRhs, value))
+        continue;
+      knownZero &= ~value;
+      knownOne &= value;
+      defined = true;
+    }
+    // Nothing left to learn once every bit is unknown
+    if ((knownZero | knownOne) == 0)
+      break;
+  }
+  if (!defined)
+    return llvm::None;
+  return FixedKnownBits<BW>{knownZero & Mask, knownOne};
+}
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_BINARYOPS_H
@@ -0,0 +1,157 @@
+// Per-output-bit decision procedure for optimal mulhs at widths up to 64.
+//
+// For every bit of the high half we must decide whether 0, 1 or both are
+// reachable. The search assigns unknown input bits from the most significant
+// down. At each node the remaining unknowns span a signed interval for each
+// operand, and the four corner products bound every product in the subtree:
+//
+//   * The corners are themselves concretizations, so each one marks the
+//     values of all output bits as reachable.
+//   * A product bit j is constant over [pmin, pmax] iff pmin >> j equals
+//     pmax >> j. Those bits are already covered by the corner samples, so
+//     a subtree whose varying bits are all decided is pruned.
+//
+// The search stops early once every output bit has been seen as both 0 and
+// 1. A node limit bounds the worst case; past it the composite is returned.
+
+#ifndef ABSTRACTTF_BRANCHANDBOUND_H
+#define ABSTRACTTF_BRANCHANDBOUND_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <llvm/ADT/APInt.h>
+#include <llvm/Support/KnownBits.h>
+
+namespace abstracttf {
+
+using llvm::APInt;
+using llvm::KnownBits;
+
+constexpr uint64_t DefaultBranchAndBoundNodeLimit = uint64_t(1) << 22;
+
+struct BranchAndBoundResult {
+  KnownBits result;
+  bool exact = false; // False if the node limit was hit
+  uint64_t nodes = 0; // Search nodes visited
+};
+
+namespace detail {
+
+class MulhsBranchAndBound {
+public:
+  MulhsBranchAndBound(unsigned bw, uint64_t nodeLimit)
+      : bw(bw), mask(bw == 64 ? ~uint64_t(0) : (uint64_t(1) << bw) - 1),
+        signBit(uint64_t(1) << (bw - 1)), nodeLimit(nodeLimit) {}
+
+  // Returns false if the node limit was exceeded
+  bool run(uint64_t lZero, uint64_t lOne, uint64_t rZero, uint64_t rOne) {
+    return search(lZero, lOne, rZero, rOne);
+  }
+
+  uint64_t seenZero = 0; // Output bits observed as 0
+  uint64_t seenOne = 0;  // Output bits observed as 1
+  uint64_t nodes = 0;
+
+private:
+  __int128 sext(uint64_t value) const {
+    unsigned shift = 64 - bw;
+    return static_cast<int64_t>(value << shift) >> shift;
+  }
+
+  void sample(__int128 product) {
+    uint64_t high = static_cast<uint64_t>(product >> bw) & mask;
+    seenZero |= ~high & mask;
+    seenOne |= high;
+  }
+
+  bool decided() const { return (seenZero & seenOne) == mask; }
+
+  bool search(uint64_t lZero, uint64_t lOne, uint64_t rZero, uint64_t rOne) {
+    if (++nodes > nodeLimit)
+      return false;
+
+    uint64_t lUnknown = ~(lZero | lOne) & mask;
+    uint64_t rUnknown = ~(rZero | rOne) & mask;
+
+    // Signed bounds: an unknown sign bit goes to 1 for the minimum and to 0
+    // for the maximum, every other unknown bit the opposite way.
+    __int128 lMin = sext(lOne | (lUnknown & signBit));
+    __int128 lMax = sext(lOne | (lUnknown & ~signBit));
+    __int128 rMin = sext(rOne | (rUnknown & signBit));
+    __int128 rMax = sext(rOne | (rUnknown & ~signBit));
+
+    __int128 corners[4] = {lMin * rMin, lMin * rMax, lMax * rMin,
+                           lMax * rMax};
+    for (__int128 corner : corners)
+      sample(corner);
+    if (decided() || (lUnknown | rUnknown) == 0)
+      return true;
+
+    __int128 pMin = *std::min_element(corners, corners + 4);
+    __int128 pMax = *std::max_element(corners, corners + 4);
+
+    // Output bits that may vary inside this subtree: product bits at or
+    // below the highest bit where pMin and pMax differ.
+    unsigned __int128 diff =
+        static_cast<unsigned __int128>(pMin) ^ static_cast<unsigned __int128>(pMax);
+    uint64_t diffHigh = static_cast<uint64_t>(diff >> 64);
+    uint64_t diffLow = static_cast<uint64_t>(diff);
+    unsigned highestDiff = diffHigh   ? 127 - __builtin_clzll(diffHigh)
+                           : diffLow ? 63 - __builtin_clzll(diffLow)
+                                     : 0;
+    if (highestDiff < bw)
+      return true; // Only low product bits vary
+    unsigned varyingOutputBits = highestDiff - bw + 1;
+    uint64_t varying = varyingOutputBits >= 64
+                           ? mask
+                           : ((uint64_t(1) << varyingOutputBits) - 1) & mask;
+    if ((varying & ~(seenZero & seenOne)) == 0)
+      return true;
+
+    // Branch on the most significant unknown input bit
+    bool branchLhs = lUnknown >= rUnknown;
+    uint64_t unknown = branchLhs ? lUnknown : rUnknown;
+    uint64_t bit = uint64_t(1) << (63 - __builtin_clzll(unknown));
+    if (branchLhs)
+      return search(lZero | bit, lOne, rZero, rOne) &&
+             (decided() || search(lZero, lOne | bit, rZero, rOne));
+    return search(lZero, lOne, rZero | bit, rOne) &&
+           (decided() || search(lZero, lOne, rZero, rOne | bit));
+  }
+
+  unsigned bw;
+  uint64_t mask;
+  uint64_t signBit;
+  uint64_t nodeLimit;
+};
+
+} // namespace detail
+
+inline BranchAndBoundResult
+branchAndBoundMulhs(const KnownBits &lhs, const KnownBits &rhs,
+                    uint64_t nodeLimit = DefaultBranchAndBoundNodeLimit) {
+  unsigned bw = lhs.getBitWidth();
+  assert(bw >= 1 && bw <= 64 && bw == rhs.getBitWidth() &&
+         "Branch and bound supports matching widths up to 64 bits");
+
+  detail::MulhsBranchAndBound search(bw, nodeLimit);
+  BranchAndBoundResult result;
+  result.exact =
+      search.run(lhs.Zero.getZExtValue(), lhs.One.getZExtValue(),
+                 rhs.Zero.getZExtValue(), rhs.One.getZExtValue());
+  result.nodes = search.nodes;
+  if (!result.exact) {
+    result.result = KnownBits::mulhs(lhs, rhs);
+    return result;
+  }
+
+  result.result = KnownBits(bw);
+  result.result.Zero = APInt(bw, ~search.seenOne & search.seenZero);
+  result.result.One = APInt(bw, ~search.seenZero & search.seenOne);
+  return result;
+}
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_BRANCHANDBOUND_H
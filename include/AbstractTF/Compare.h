@@ -0,0 +1,127 @@
+// Precision comparison between two KnownBits results for the same query.
+
+#ifndef ABSTRACTTF_COMPARE_H
+#define ABSTRACTTF_COMPARE_H
+
+#include <cassert>
+#include <cstdint>
+#include <llvm/Support/KnownBits.h>
+
+namespace abstracttf {
+
+using llvm::KnownBits;
+
+enum class PrecisionOrder {
+  FirstMorePrecise,
+  SecondMorePrecise,
+  Same,
+  Incomparable,
+};
+
+// Number of known bits in `kb`; a larger count means a more precise value.
+inline unsigned knownBitCount(const KnownBits &kb) {
+  return kb.Zero.countPopulation() + kb.One.countPopulation();
+}
+
+inline unsigned unknownBitCount(const KnownBits &kb) {
+  return kb.getBitWidth() - knownBitCount(kb);
+}
+
+inline PrecisionOrder comparePrecision(const KnownBits &first,
+                                       const KnownBits &second) {
+  assert(first.getBitWidth() == second.getBitWidth() &&
+         "Results must have the same bitwidth");
+
+  // Check if results are comparable
+  if (first.Zero.intersects(second.One) || first.One.intersects(second.Zero))
+    return PrecisionOrder::Incomparable;
+
+  // Check which transfer function is more precise
+  unsigned firstPrecision = knownBitCount(first);
+  unsigned secondPrecision = knownBitCount(second);
+
+  if (firstPrecision > secondPrecision)
+    return PrecisionOrder::FirstMorePrecise;
+  if (secondPrecision > firstPrecision)
+    return PrecisionOrder::SecondMorePrecise;
+  return PrecisionOrder::Same;
+}
+
+// How a result stands against the optimal result of the same query. Known
+// bit counts cannot tell these apart, so they are judged on the masks: the
+// result is Optimal if both masks are equal, Imprecise if each mask is a
+// subset of the optimal one, and Unsound if it claims any bit the optimal
+// result does not.
+enum class ResultVerdict { Optimal, Imprecise, Unsound };
+
+inline ResultVerdict classifyMasks(uint64_t zero, uint64_t one,
+                                   uint64_t optimalZero, uint64_t optimalOne) {
+  if (zero == optimalZero && one == optimalOne)
+    return ResultVerdict::Optimal;
+  if ((zero & ~optimalZero) == 0 && (one & ~optimalOne) == 0)
+    return ResultVerdict::Imprecise;
+  return ResultVerdict::Unsound;
+}
+
+inline ResultVerdict classifyResult(const KnownBits &result,
+                                    const KnownBits &optimal) {
+  assert(result.getBitWidth() == optimal.getBitWidth() &&
+         "Results must have the same bitwidth");
+  if (result.Zero == optimal.Zero && result.One == optimal.One)
+    return ResultVerdict::Optimal;
+  if (result.Zero.isSubsetOf(optimal.Zero) &&
+      result.One.isSubsetOf(optimal.One))
+    return ResultVerdict::Imprecise;
+  return ResultVerdict::Unsound;
+}
+
+// The order progress counters record for a result with `verdict`, as if it
+// had been compared against the optimal result with comparePrecision
+inline PrecisionOrder verdictOrder(ResultVerdict verdict) {
+  switch (verdict) {
+  case ResultVerdict::Optimal:
+    return PrecisionOrder::Same;
+  case ResultVerdict::Imprecise:
+    return PrecisionOrder::SecondMorePrecise;
+  case ResultVerdict::Unsound:
+    break;
+  }
+  return PrecisionOrder::Incomparable;
+}
+
+// Tally of `comparePrecision(composite, oracle)` outcomes.
+struct PrecisionCounts {
+  uint64_t compositeMorePrecise = 0;
+  uint64_t naiveMorePrecise = 0;
+  uint64_t samePrecision = 0;
+  uint64_t incomparableResults = 0;
+
+  void add(PrecisionOrder order) {
+    switch (order) {
+    case PrecisionOrder::FirstMorePrecise:
+      compositeMorePrecise++;
+      break;
+    case PrecisionOrder::SecondMorePrecise:
+      naiveMorePrecise++;
+      break;
+    case PrecisionOrder::Same:
+      samePrecision++;
+      break;
+    case PrecisionOrder::Incomparable:
+      incomparableResults++;
+      break;
+    }
+  }
+
+  PrecisionCounts &operator+=(const PrecisionCounts &other) {
+    compositeMorePrecise += other.compositeMorePrecise;
+    naiveMorePrecise += other.naiveMorePrecise;
+    samePrecision += other.samePrecision;
+    incomparableResults += other.incomparableResults;
+    return *this;
+  }
+};
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_COMPARE_H
@@ -0,0 +1,61 @@
+// Concretization (gamma) of a KnownBits value into the set of integers it
+// describes.
+
+#ifndef ABSTRACTTF_CONCRETIZATION_H
+#define ABSTRACTTF_CONCRETIZATION_H
+
+#include <cstdint>
+#include <llvm/ADT/APInt.h>
+#include <llvm/Support/KnownBits.h>
+#include <vector>
+
+namespace abstracttf {
+
+using llvm::APInt;
+using llvm::KnownBits;
+
+// Indexes of all bits of `kb` that are neither known zero nor known one.
+inline std::vector<unsigned> unknownIndexes(const KnownBits &kb) {
+  unsigned bw = kb.getBitWidth();
+  std::vector<unsigned> result;
+  for (unsigned i = 0; i < bw; i++) {
+    if (!kb.Zero[i] && !kb.One[i]) {
+      result.push_back(i);
+    }
+  }
+  return result;
+}
+
+// Call `fn(const APInt &)` once for every concrete value described by `kb`,
+// without materializing the whole set.
+template <typename Fn>
+inline void forEachConcretization(const KnownBits &kb, Fn &&fn) {
+  std::vector<unsigned> unknowns = unknownIndexes(kb);
+
+  // All possible combinations is 2^numUnknownIndexes
+  uint64_t total = 1ull << unknowns.size();
+
+  for (uint64_t i = 0; i < total; i++) {
+    APInt ap = kb.One; // Start with all values known to be 1
+    uint64_t temp = i;
+    for (const unsigned unknownIdx : unknowns) {
+      if (temp & 1) {
+        ap.setBit(unknownIdx);
+      } else {
+        ap.clearBit(unknownIdx);
+      }
+      temp /= 2;
+    }
+    fn(static_cast<const APInt &>(ap));
+  }
+}
+
+inline std::vector<APInt> concretization(const KnownBits &kb) {
+  std::vector<APInt> result;
+  forEachConcretization(kb, [&](const APInt &ap) { result.push_back(ap); });
+  return result;
+}
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_CONCRETIZATION_H
@@ -0,0 +1,236 @@
+// Search for the most general inputs at which KnownBits::mulhs is not
+// optimal.
+//
+// Pairs are visited level by level, from the most unknown bits in total to
+// the fewest. A pair is covered if it was reported or if any single-bit
+// generalization of it (a parent on either operand, one level up) is
+// covered; covered pairs are skipped without running the oracle. Reported
+// pairs are therefore exactly the imprecise pairs none of whose
+// generalizations was reported, and every refinement of a root cause is
+// pruned instead of being listed again.
+
+#ifndef ABSTRACTTF_COUNTEREXAMPLES_H
+#define ABSTRACTTF_COUNTEREXAMPLES_H
+
+#include "AbstractTF/FixedWidth.h"
+#include "AbstractTF/Format.h"
+#include "AbstractTF/LatticeIndex.h"
+#include "AbstractTF/Parallel.h"
+#include "AbstractTF/Progress.h"
+#include "AbstractTF/Sweep.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <llvm/Support/KnownBits.h>
+#include <ostream>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace abstracttf {
+
+using llvm::KnownBits;
+
+// Widest width searched: the covered set holds one bit per pair, 9^BW bits.
+constexpr unsigned MaxCounterexampleBitWidth = 9;
+
+struct MulhsCounterexample {
+  uint64_t lhsRank = 0, rhsRank = 0;
+  KnownBits lhs, rhs, composite, optimal;
+  ResultVerdict verdict = ResultVerdict::Optimal;
+};
+
+struct CounterexampleResult {
+  unsigned bitWidth = 0;
+  uint64_t totalPairs = 0;
+  uint64_t evaluated = 0; // Pairs the oracle ran on
+  uint64_t imprecise = 0; // Reported pairs where the composite is sound
+                          // but less precise than the oracle
+  uint64_t unsound = 0;   // Reported pairs where the composite claims a
+                          // bit the oracle does not
+  // Reported pairs by total number of unknown bits
+  std::vector<uint64_t> byLevel;
+  // The first reported pairs, most general first
+  std::vector<MulhsCounterexample> examples;
+  double seconds = 0.0;
+
+  uint64_t reported() const { return imprecise + unsound; }
+};
+
+// Ranks with `level` unknown bits, in LatticeIndex::forEachAtLevel order
+inline std::vector<uint64_t> ranksAtLevel(const LatticeIndex &lattice,
+                                          unsigned level) {
+  std::vector<uint64_t> ranks;
+  ranks.reserve(lattice.levelSize(level));
+  lattice.forEachAtLevel(level,
+                         [&](uint64_t rank, uint32_t) { ranks.push_back(rank); });
+  return ranks;
+}
+
+template <unsigned BW>
+inline CounterexampleResult findMaximalMulhsCounterexamples(
+    const SweepOptions &options, size_t maxExamples) {
+  static_assert(BW <= MaxCounterexampleBitWidth, "Covered set would not fit");
+  auto start = std::chrono::steady_clock::now();
+  const LatticeIndex lattice(BW);
+  const uint64_t n = lattice.size();
+  std::vector<std::atomic<uint64_t>> covered((n * n + 63) / 64);
+  auto isCovered = [&](uint64_t lhs, uint64_t rhs) {
+    uint64_t pair = lhs * n + rhs;
+    return covered[pair / 64].load(std::memory_order_relaxed) >> (pair % 64) &
+           1;
+  };
+  auto cover = [&](uint64_t lhs, uint64_t rhs) {
+    uint64_t pair = lhs * n + rhs;
+    covered[pair / 64].fetch_or(uint64_t(1) << (pair % 64),
+                                std::memory_order_relaxed);
+  };
+
+  std::vector<std::vector<uint64_t>> levels(BW + 1);
+  for (unsigned level = 0; level <= BW; level++)
+    levels[level] = ranksAtLevel(lattice, level);
+
+  unsigned numThreads = std::max(1u, options.numThreads);
+  SweepCounters threadCounters(options);
+  std::vector<CounterexampleResult> partials(numThreads);
+  for (CounterexampleResult &partial : partials)
+    partial.byLevel.assign(2 * BW + 1, 0);
+  CounterexampleResult result;
+  result.bitWidth = BW;
+  result.totalPairs = n * n;
+  result.byLevel.assign(2 * BW + 1, 0);
+
+  for (unsigned total = 2 * BW + 1; total-- > 0;) {
+    for (CounterexampleResult &partial : partials)
+      partial.examples.clear();
+    unsigned minLhs = total > BW ? total - BW : 0;
+    unsigned maxLhs = std::min(total, BW);
+    for (unsigned lhsLevel = minLhs; lhsLevel <= maxLhs; lhsLevel++) {
+      const std::vector<uint64_t> &lhsRanks = levels[lhsLevel];
+      const std::vector<uint64_t> &rhsRanks = levels[total - lhsLevel];
+      parallelFor(lhsRanks.size(), numThreads, [&](size_t i, unsigned thread) {
+        WorkerCounters &counters = threadCounters[thread];
+        CounterexampleResult &partial = partials[thread];
+        uint64_t lhsRank = lhsRanks[i];
+        RankMasks lhsMasks = lattice.masksOf(lhsRank);
+        FixedKnownBits<BW> lhs{lhsMasks.Zero, lhsMasks.One};
+        KnownBits lhsKB = lhs.toKnownBits();
+        for (uint64_t rhsRank : rhsRanks) {
+          bool parentCovered = false;
+          lattice.forEachParent(lhsRank, [&](uint64_t parent, unsigned) {
+            parentCovered = parentCovered || isCovered(parent, rhsRank);
+          });
+          lattice.forEachParent(rhsRank, [&](uint64_t parent, unsigned) {
+            parentCovered = parentCovered || isCovered(lhsRank, parent);
+          });
+          if (parentCovered) {
+            cover(lhsRank, rhsRank);
+            counters.skip();
+            continue;
+          }
+
+          RankMasks rhsMasks = lattice.masksOf(rhsRank);
+          FixedKnownBits<BW> rhs{rhsMasks.Zero, rhsMasks.One};
+          KnownBits rhsKB = rhs.toKnownBits();
+          FixedKnownBits<BW> composite =
+              FixedKnownBits<BW>::fromKnownBits(KnownBits::mulhs(lhsKB, rhsKB));
+          FixedKnownBits<BW> optimal = fixedNaiveMulhs(lhs, rhs);
+          ResultVerdict verdict = classifyResult(composite, optimal);
+          partial.evaluated++;
+          counters.add(verdictOrder(verdict));
+          if (verdict == ResultVerdict::Optimal)
+            continue;
+
+          cover(lhsRank, rhsRank);
+          if (verdict == ResultVerdict::Unsound)
+            partial.unsound++;
+          else
+            partial.imprecise++;
+          partial.byLevel[total]++;
+          if (partial.examples.size() < maxExamples)
+            partial.examples.push_back({lhsRank, rhsRank, lhsKB, rhsKB,
+                                        composite.toKnownBits(),
+                                        optimal.toKnownBits(), verdict});
+        }
+      });
+    }
+
+    // Keep the examples of a level in rank order, whatever the threads did
+    std::vector<MulhsCounterexample> levelExamples;
+    for (CounterexampleResult &partial : partials)
+      for (MulhsCounterexample &example : partial.examples)
+        levelExamples.push_back(std::move(example));
+    std::sort(levelExamples.begin(), levelExamples.end(),
+              [](const MulhsCounterexample &a, const MulhsCounterexample &b) {
+                return std::tie(a.lhsRank, a.rhsRank) <
+                       std::tie(b.lhsRank, b.rhsRank);
+              });
+    for (MulhsCounterexample &example : levelExamples)
+      if (result.examples.size() < maxExamples)
+        result.examples.push_back(std::move(example));
+  }
+
+  for (CounterexampleResult &partial : partials) {
+    result.evaluated += partial.evaluated;
+    result.imprecise += partial.imprecise;
+    result.unsound += partial.unsound;
+    for (unsigned level = 0; level <= 2 * BW; level++)
+      result.byLevel[level] += partial.byLevel[level];
+  }
+  result.seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  return result;
+}
+
+using CounterexampleSearchFn = CounterexampleResult (*)(const SweepOptions &,
+                                                        size_t);
+
+template <size_t... Is>
+constexpr std::array<CounterexampleSearchFn, sizeof...(Is) + 1>
+makeCounterexampleSearchTable(std::index_sequence<Is...>) {
+  return {nullptr, &findMaximalMulhsCounterexamples<Is + 1>...};
+}
+
+// Returns the maximal counterexample search for `bitWidth`, or nullptr if
+// the width is out of reach.
+inline CounterexampleSearchFn getCounterexampleSearch(unsigned bitWidth) {
+  static constexpr std::array<CounterexampleSearchFn,
+                              MaxCounterexampleBitWidth + 1>
+      Table = makeCounterexampleSearchTable(
+          std::make_index_sequence<MaxCounterexampleBitWidth>());
+  if (bitWidth == 0 || bitWidth > MaxCounterexampleBitWidth)
+    return nullptr;
+  return Table[bitWidth];
+}
+
+inline void printCounterexampleResult(std::ostream &os,
+                                      const CounterexampleResult &result) {
+  os << "Maximal mulhs counterexamples for BitWidth = " << result.bitWidth
+     << std::endl;
+  os << "Pairs: " << result.totalPairs << std::endl;
+  os << "Pairs evaluated: " << result.evaluated << " (pruned "
+     << result.totalPairs - result.evaluated << ")" << std::endl;
+  os << "Maximal imprecise pairs: " << result.imprecise << std::endl;
+  os << "Maximal unsound pairs: " << result.unsound << std::endl;
+  os << "By total unknown bits:";
+  for (unsigned level = result.byLevel.size(); level-- > 0;)
+    if (result.byLevel[level])
+      os << " " << level << ":" << result.byLevel[level];
+  os << std::endl;
+  for (const MulhsCounterexample &example : result.examples)
+    os << "  mulhs(" << formatKnownBits(example.lhs) << ", "
+       << formatKnownBits(example.rhs)
+       << ") = " << formatKnownBits(example.composite) << ", optimal "
+       << formatKnownBits(example.optimal)
+       << (example.verdict == ResultVerdict::Unsound ? " (unsound)" : "")
+       << std::endl;
+  os << "Search time: " << result.seconds << " s" << std::endl << std::endl;
+}
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_COUNTEREXAMPLES_H
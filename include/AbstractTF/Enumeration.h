@@ -0,0 +1,62 @@
+// Enumeration of every KnownBits value of a given bit width.
+
+#ifndef ABSTRACTTF_ENUMERATION_H
+#define ABSTRACTTF_ENUMERATION_H
+
+#include <cassert>
+#include <cstdint>
+#include <llvm/Support/KnownBits.h>
+#include <vector>
+
+namespace abstracttf {
+
+using llvm::KnownBits;
+
+// Number of KnownBits values of width `bitWidth`, i.e. 3^bitWidth.
+inline uint64_t numKnownBits(unsigned bitWidth) {
+  uint64_t total = 1;
+  for (unsigned i = 0; i < bitWidth; i++) {
+    total *= 3;
+  }
+  return total;
+}
+
+// Decode `rank` as a base-3 number whose digit `i` describes bit `i`:
+// 0 is a known zero, 1 is a known one and 2 is unknown.
+inline KnownBits knownBitsFromRank(unsigned bitWidth, uint64_t rank) {
+  KnownBits kb(bitWidth);
+  uint64_t temp = rank;
+
+  for (unsigned bit = 0; bit < bitWidth; bit++) {
+    uint64_t digit = temp % 3; // 0, 1, or unknown
+    temp /= 3;                 // Move to next tertiary "bit"
+    if (digit == 0) {          // Check cases
+      kb.Zero.setBit(bit);
+    } else if (digit == 1) {
+      kb.One.setBit(bit);
+    }
+  }
+
+  assert(!kb.hasConflict() && "Known 0s and 1s should not conflict");
+  return kb;
+}
+
+inline std::vector<KnownBits> enumerateFromBitWidth(unsigned bitWidth) {
+  // Each KnownBit can be either 0, 1, or unknown.
+  // This corresponds to finding all tertiary numbers
+  // with bitwidth of `bitWidth`
+  uint64_t total = numKnownBits(bitWidth);
+
+  std::vector<KnownBits> result;
+  result.reserve(total); // We know there will be `total` numbers
+
+  for (uint64_t i = 0; i < total; i++) {
+    result.push_back(knownBitsFromRank(bitWidth, i));
+  }
+
+  return result;
+}
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_ENUMERATION_H
@@ -0,0 +1,243 @@
+// Compile-time bit-width specialized kernels.
+//
+// For widths up to 16 bits a KnownBits value fits in two 32-bit masks and a
+// signed 2 * BW bit product fits in an int32_t, so the enumeration,
+// concretization, oracle and comparison kernels below work on plain unsigned
+// integers with constexpr masks instead of APInt.
+
+#ifndef ABSTRACTTF_FIXEDWIDTH_H
+#define ABSTRACTTF_FIXEDWIDTH_H
+
+#include "AbstractTF/Compare.h"
+#include "AbstractTF/Enumeration.h"
+
+#include <cstdint>
+#include <llvm/ADT/APInt.h>
+#include <llvm/Support/KnownBits.h>
+#include <vector>
+
+namespace abstracttf {
+
+using llvm::APInt;
+using llvm::KnownBits;
+
+// Largest width handled by the fixed-width kernels.
+constexpr unsigned MaxFixedBitWidth = 16;
+
+template <unsigned BW> struct FixedKnownBits {
+  static_assert(BW >= 1 && BW <= MaxFixedBitWidth,
+                "Fixed-width kernels support widths 1-16");
+
+  static constexpr uint32_t Mask = (uint32_t(1) << BW) - 1;
+  static constexpr uint32_t SignBit = uint32_t(1) << (BW - 1);
+
+  uint32_t Zero = 0;
+  uint32_t One = 0;
+
+  constexpr uint32_t unknown() const { return ~(Zero | One) & Mask; }
+
+  static FixedKnownBits fromKnownBits(const KnownBits &kb) {
+    assert(kb.getBitWidth() == BW && "Bitwidth mismatch");
+    return {static_cast<uint32_t>(kb.Zero.getZExtValue()),
+            static_cast<uint32_t>(kb.One.getZExtValue())};
+  }
+
+  KnownBits toKnownBits() const {
+    KnownBits kb(BW);
+    kb.Zero = APInt(BW, Zero);
+    kb.One = APInt(BW, One);
+    return kb;
+  }
+};
+
+// A result in a table of whole-width results; widths up to 8 fit a byte
+// per mask.
+struct PackedKnownBits {
+  uint8_t Zero = 0;
+  uint8_t One = 0;
+};
+
+// Same rank order as `enumerateFromBitWidth`: base-3 digit `i` describes
+// bit `i` with 0 = known zero, 1 = known one, 2 = unknown.
+template <unsigned BW>
+inline FixedKnownBits<BW> fixedKnownBitsFromRank(uint64_t rank) {
+  FixedKnownBits<BW> kb;
+  for (unsigned bit = 0; bit < BW; bit++) {
+    uint64_t digit = rank % 3;
+    rank /= 3;
+    if (digit == 0)
+      kb.Zero |= uint32_t(1) << bit;
+    else if (digit == 1)
+      kb.One |= uint32_t(1) << bit;
+  }
+  return kb;
+}
+
+template <unsigned BW>
+inline std::vector<FixedKnownBits<BW>> enumerateFixedWidth() {
+  uint64_t total = numKnownBits(BW);
+
+  std::vector<FixedKnownBits<BW>> result;
+  result.reserve(total);
+
+  for (uint64_t i = 0; i < total; i++)
+    result.push_back(fixedKnownBitsFromRank<BW>(i));
+
+  return result;
+}
+
+// Call `fn(uint32_t)` for every concrete value described by `kb`. The
+// subsets of the unknown mask are walked with the usual `(s - u) & u` step,
+// so the loop carries no per-bit work.
+template <unsigned BW, typename Fn>
+inline void forEachFixedConcretization(FixedKnownBits<BW> kb, Fn &&fn) {
+  const uint32_t unknown = kb.unknown();
+  uint32_t subset = 0;
+  do {
+    fn(kb.One | subset);
+    subset = (subset - unknown) & unknown;
+  } while (subset != 0);
+}
+
+template <unsigned BW> constexpr int32_t fixedSext(uint32_t value) {
+  return static_cast<int32_t>(value << (32 - BW)) >> (32 - BW);
+}
+
+template <unsigned BW>
+constexpr uint32_t fixedConcreteMulhs(uint32_t lhs, uint32_t rhs) {
+  int32_t prod = fixedSext<BW>(lhs) * fixedSext<BW>(rhs);
+  return static_cast<uint32_t>(prod >> BW) & FixedKnownBits<BW>::Mask;
+}
+
+// Optimal transfer function for `op(uint32_t, uint32_t) -> uint32_t`,
+// abstracting the results on the fly.
+template <unsigned BW, typename ConcreteOp>
+inline FixedKnownBits<BW> fixedOptimalTransfer(FixedKnownBits<BW> lhs,
+                                               FixedKnownBits<BW> rhs,
+                                               ConcreteOp &&op) {
+  constexpr uint32_t Mask = FixedKnownBits<BW>::Mask;
+  uint32_t knownZero = Mask;
+  uint32_t knownOne = Mask;
+  forEachFixedConcretization(lhs, [&](uint32_t cLhs) {
+    forEachFixedConcretization(rhs, [&](uint32_t cRhs) {
+      uint32_t value = op(cLhs, cRhs);
+      knownZero &= ~value;
+      knownOne &= value;
+    });
+  });
+  return {knownZero & Mask, knownOne};
+}
+
+// Corner concretizations of `kb`, at most four and without duplicates: its
+// signed minimum and maximum, then their sign-flipped partners (the
+// smallest and largest values when the sign bit is unknown). Returns how
+// many were written to `out`.
+template <unsigned BW>
+inline unsigned fixedCornerValues(FixedKnownBits<BW> kb, uint32_t (&out)[4]) {
+  const uint32_t unknown = kb.unknown();
+  const uint32_t sign = unknown & FixedKnownBits<BW>::SignBit;
+  const uint32_t rest = unknown & ~FixedKnownBits<BW>::SignBit;
+  const uint32_t candidates[4] = {kb.One | sign, kb.One | rest, kb.One,
+                                  kb.One | sign | rest};
+  unsigned count = 0;
+  for (uint32_t value : candidates) {
+    bool seen = false;
+    for (unsigned i = 0; i < count; i++)
+      seen |= out[i] == value;
+    if (!seen)
+      out[count++] = value;
+  }
+  return count;
+}
+
+// Optimal mulhs that stops as soon as every result bit is unknown. With
+// `CornersFirst`, the products of the operands' corner values are tried
+// before the ordinary subset walk: products at the signed extremes differ
+// in the high bits early, so saturating queries usually end within a few
+// products. If `products` is given it receives the number of products
+// evaluated.
+template <unsigned BW, bool CornersFirst = true>
+inline FixedKnownBits<BW> fixedSaturatingMulhs(FixedKnownBits<BW> lhs,
+                                               FixedKnownBits<BW> rhs,
+                                               uint64_t *products = nullptr) {
+  constexpr uint32_t Mask = FixedKnownBits<BW>::Mask;
+  uint32_t knownZero = Mask;
+  uint32_t knownOne = Mask;
+  uint64_t count = 0;
+  // Returns true once the result is top
+  auto visit = [&](uint32_t cLhs, uint32_t cRhs) {
+    uint32_t value = fixedConcreteMulhs<BW>(cLhs, cRhs);
+    knownZero &= ~value;
+    knownOne &= value;
+    count++;
+    return ((knownZero | knownOne) & Mask) == 0;
+  };
+  auto walk = [&] {
+    if constexpr (CornersFirst) {
+      uint32_t lhsCorners[4], rhsCorners[4];
+      unsigned numLhs = fixedCornerValues(lhs, lhsCorners);
+      unsigned numRhs = fixedCornerValues(rhs, rhsCorners);
+      for (unsigned i = 0; i < numLhs; i++)
+        for (unsigned j = 0; j < numRhs; j++)
+          if (visit(lhsCorners[i], rhsCorners[j]))
+            return;
+    }
+    const uint32_t lhsUnknown = lhs.unknown();
+    const uint32_t rhsUnknown = rhs.unknown();
+    uint32_t lhsSubset = 0;
+    do {
+      uint32_t rhsSubset = 0;
+      do {
+        if (visit(lhs.One | lhsSubset, rhs.One | rhsSubset))
+          return;
+        rhsSubset = (rhsSubset - rhsUnknown) & rhsUnknown;
+      } while (rhsSubset != 0);
+      lhsSubset = (lhsSubset - lhsUnknown) & lhsUnknown;
+    } while (lhsSubset != 0);
+  };
+  walk();
+  if (products)
+    *products = count;
+  return {knownZero & Mask, knownOne};
+}
+
+template <unsigned BW>
+inline FixedKnownBits<BW> fixedNaiveMulhs(FixedKnownBits<BW> lhs,
+                                          FixedKnownBits<BW> rhs) {
+  return fixedSaturatingMulhs(lhs, rhs);
+}
+
+// comparePrecision on raw (Zero, One) masks of up to 32 bits
+inline PrecisionOrder comparePrecisionMasks(uint32_t firstZero,
+                                            uint32_t firstOne,
+                                            uint32_t secondZero,
+                                            uint32_t secondOne) {
+  if ((firstZero & secondOne) || (firstOne & secondZero))
+    return PrecisionOrder::Incomparable;
+
+  unsigned firstPrecision = __builtin_popcount(firstZero | firstOne);
+  unsigned secondPrecision = __builtin_popcount(secondZero | secondOne);
+
+  if (firstPrecision > secondPrecision)
+    return PrecisionOrder::FirstMorePrecise;
+  if (secondPrecision > firstPrecision)
+    return PrecisionOrder::SecondMorePrecise;
+  return PrecisionOrder::Same;
+}
+
+template <unsigned BW>
+inline PrecisionOrder comparePrecision(FixedKnownBits<BW> first,
+                                       FixedKnownBits<BW> second) {
+  return comparePrecisionMasks(first.Zero, first.One, second.Zero,
+                               second.One);
+}
+
+template <unsigned BW>
+inline ResultVerdict classifyResult(FixedKnownBits<BW> result,
+                                    FixedKnownBits<BW> optimal) {
+  return classifyMasks(result.Zero, result.One, optimal.Zero, optimal.One);
+}
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_FIXEDWIDTH_H
@@ -0,0 +1,97 @@
+// Exhaustive sweep over the fixed-width kernels and the runtime dispatch
+// table that maps a bit width in [1, 16] to its instantiation.
+
+#ifndef ABSTRACTTF_FIXEDWIDTHSWEEP_H
+#define ABSTRACTTF_FIXEDWIDTHSWEEP_H
+
+#include "AbstractTF/FixedWidth.h"
+#include "AbstractTF/Sweep.h"
+
+#include <array>
+#include <chrono>
+#include <llvm/Support/KnownBits.h>
+#include <utility>
+#include <vector>
+
+namespace abstracttf {
+
+using llvm::KnownBits;
+
+// Like `sweepTransferFunctions`, but the oracle runs on `FixedKnownBits<BW>`.
+// The composite still takes LLVM KnownBits, so both representations of
+// every abstract value are built up front.
+template <unsigned BW, typename CompositeFn, typename OracleFn>
+inline SweepResult sweepFixedWidth(CompositeFn &&composite, OracleFn &&oracle,
+                                   const SweepOptions &options) {
+  std::vector<FixedKnownBits<BW>> allFixed = enumerateFixedWidth<BW>();
+  std::vector<KnownBits> allKnownBits;
+  allKnownBits.reserve(allFixed.size());
+  for (const FixedKnownBits<BW> &kb : allFixed)
+    allKnownBits.push_back(kb.toKnownBits());
+
+  SweepResult result;
+  result.bitWidth = BW;
+  result.totalKnownBits = allFixed.size();
+
+  auto rowCost = [&](size_t i) {
+    return pairRowCost(__builtin_popcount(allFixed[i].unknown()));
+  };
+  runSweepRows(allFixed.size(), rowCost, options, result,
+               [&](size_t i, SweepWorker &worker) {
+    for (size_t j = 0; j < allFixed.size(); j++) {
+      KnownBits compositeResult;
+      FixedKnownBits<BW> naiveResult;
+      double timeComposite, timeNaive;
+      {
+        AllocationScope scope(worker.partial.compositeAllocations);
+        auto t1 = std::chrono::high_resolution_clock::now();
+        compositeResult = composite(allKnownBits[i], allKnownBits[j]);
+        auto t2 = std::chrono::high_resolution_clock::now();
+        timeComposite = (t2 - t1).count();
+      }
+      {
+        AllocationScope scope(worker.partial.naiveAllocations);
+        auto t1 = std::chrono::high_resolution_clock::now();
+        naiveResult = oracle(allFixed[i], allFixed[j]);
+        auto t2 = std::chrono::high_resolution_clock::now();
+        timeNaive = (t2 - t1).count();
+      }
+
+      worker.record(allKnownBits[i], allKnownBits[j],
+                    comparePrecision(
+                        FixedKnownBits<BW>::fromKnownBits(compositeResult),
+                        naiveResult),
+                    timeComposite, timeNaive);
+    }
+  });
+
+  return result;
+}
+
+template <unsigned BW>
+inline SweepResult sweepMulhsFixedWidth(const SweepOptions &options) {
+  return sweepFixedWidth<BW>(KnownBits::mulhs, fixedNaiveMulhs<BW>, options);
+}
+
+using FixedSweepFn = SweepResult (*)(const SweepOptions &);
+
+template <size_t... Is>
+constexpr std::array<FixedSweepFn, sizeof...(Is) + 1>
+makeMulhsSweepTable(std::index_sequence<Is...>) {
+  // Slot 0 is unused so the table can be indexed by bit width directly.
+  return {nullptr, &sweepMulhsFixedWidth<Is + 1>...};
+}
+
+// Returns the fixed-width mulhs sweep for `bitWidth`, or nullptr if the
+// width has no specialization.
+inline FixedSweepFn getMulhsFixedWidthSweep(unsigned bitWidth) {
+  static constexpr std::array<FixedSweepFn, MaxFixedBitWidth + 1> Table =
+      makeMulhsSweepTable(std::make_index_sequence<MaxFixedBitWidth>());
+  if (bitWidth == 0 || bitWidth > MaxFixedBitWidth)
+    return nullptr;
+  return Table[bitWidth];
+}
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_FIXEDWIDTHSWEEP_H
@@ -0,0 +1,57 @@
+// Text form of KnownBits values: one character per bit, most significant
+// first, '0' and '1' for known bits and '?' for unknown ones.
+//
+// parseKnownBits is the inverse and reads straight out of the caller's
+// buffer, so it can be pointed at a mapped file or a socket buffer.
+
+#ifndef ABSTRACTTF_FORMAT_H
+#define ABSTRACTTF_FORMAT_H
+
+#include <llvm/ADT/APInt.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/KnownBits.h>
+#include <string>
+
+namespace abstracttf {
+
+using llvm::KnownBits;
+
+inline std::string formatKnownBits(const KnownBits &kb) {
+  unsigned bw = kb.getBitWidth();
+  std::string text(bw, '?');
+  for (unsigned i = 0; i < bw; i++) {
+    if (kb.Zero[i])
+      text[bw - 1 - i] = '0';
+    else if (kb.One[i])
+      text[bw - 1 - i] = '1';
+  }
+  return text;
+}
+
+// Parses `text` in the format above into `kb`, which takes the width of
+// the text. Returns false on an empty string or any other character.
+inline bool parseKnownBits(llvm::StringRef text, KnownBits &kb) {
+  unsigned bw = text.size();
+  if (bw == 0)
+    return false;
+  kb = KnownBits(bw);
+  for (unsigned i = 0; i < bw; i++) {
+    switch (text[bw - 1 - i]) {
+    case '0':
+      kb.Zero.setBit(i);
+      break;
+    case '1':
+      kb.One.setBit(i);
+      break;
+    case '?':
+      break;
+    default:
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_FORMAT_H
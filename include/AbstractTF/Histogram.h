@@ -0,0 +1,240 @@
+// Latency distributions for transfer function calls.
+//
+// LatencyHistogram is HDR-style: values below 32 ns get their own bucket,
+// larger values are bucketed by power of two with 16 linear sub-buckets,
+// so any percentile is reported within about 6% over the full uint64_t
+// range in under 8 KiB. LatencyProfile keeps one histogram per
+// (lhs unknowns, rhs unknowns) input class for both implementations, plus
+// the slowest concrete input pairs.
+
+#ifndef ABSTRACTTF_HISTOGRAM_H
+#define ABSTRACTTF_HISTOGRAM_H
+
+#include "AbstractTF/Compare.h"
+#include "AbstractTF/Format.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <llvm/Support/KnownBits.h>
+#include <ostream>
+#include <queue>
+#include <vector>
+
+namespace abstracttf {
+
+using llvm::KnownBits;
+
+class LatencyHistogram {
+public:
+  static constexpr unsigned SubBucketBits = 4;
+  static constexpr unsigned SubBuckets = 1u << SubBucketBits;
+  static constexpr unsigned LinearLimit = 2 * SubBuckets; // Exact below this
+  static constexpr unsigned NumBuckets =
+      LinearLimit + (64 - SubBucketBits - 1) * SubBuckets;
+
+  void record(uint64_t value) {
+    buckets[bucketIndex(value)]++;
+    total++;
+    maxValue = std::max(maxValue, value);
+  }
+
+  LatencyHistogram &operator+=(const LatencyHistogram &other) {
+    for (unsigned i = 0; i < NumBuckets; i++)
+      buckets[i] += other.buckets[i];
+    total += other.total;
+    maxValue = std::max(maxValue, other.maxValue);
+    return *this;
+  }
+
+  uint64_t count() const { return total; }
+  uint64_t max() const { return maxValue; }
+
+  // Upper bound of the bucket holding the `p`-th percentile (0 < p <= 100)
+  uint64_t percentile(double p) const {
+    if (total == 0)
+      return 0;
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(
+                                              p / 100.0 * total + 0.5));
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < NumBuckets; i++) {
+      seen += buckets[i];
+      if (seen >= rank)
+        return std::min(bucketUpperBound(i), maxValue);
+    }
+    return maxValue;
+  }
+
+private:
+  static unsigned bucketIndex(uint64_t value) {
+    if (value < LinearLimit)
+      return value;
+    unsigned msb = 63 - __builtin_clzll(value);
+    unsigned shift = msb - SubBucketBits;
+    unsigned sub = (value >> shift) - SubBuckets;
+    return LinearLimit + (msb - SubBucketBits - 1) * SubBuckets + sub;
+  }
+
+  static uint64_t bucketUpperBound(unsigned index) {
+    if (index < LinearLimit)
+      return index;
+    unsigned msb = (index - LinearLimit) / SubBuckets + SubBucketBits + 1;
+    uint64_t sub = SubBuckets + (index - LinearLimit) % SubBuckets;
+    unsigned shift = msb - SubBucketBits;
+    return ((sub + 1) << shift) - 1;
+  }
+
+  std::array<uint64_t, NumBuckets> buckets{};
+  uint64_t total = 0;
+  uint64_t maxValue = 0;
+};
+
+struct SlowPair {
+  uint64_t latency; // nanoseconds
+  KnownBits lhs;
+  KnownBits rhs;
+
+  bool operator>(const SlowPair &other) const {
+    return latency > other.latency;
+  }
+};
+
+// The `capacity` slowest pairs seen so far
+class SlowestPairs {
+public:
+  explicit SlowestPairs(unsigned capacity) : capacity(capacity) {}
+
+  void offer(uint64_t latency, const KnownBits &lhs, const KnownBits &rhs) {
+    if (capacity == 0)
+      return;
+    if (heap.size() < capacity) {
+      heap.push({latency, lhs, rhs});
+    } else if (latency > heap.top().latency) {
+      heap.pop();
+      heap.push({latency, lhs, rhs});
+    }
+  }
+
+  void merge(const SlowestPairs &other) {
+    auto copy = other.heap;
+    while (!copy.empty()) {
+      offer(copy.top().latency, copy.top().lhs, copy.top().rhs);
+      copy.pop();
+    }
+  }
+
+  // Slowest first
+  std::vector<SlowPair> sorted() const {
+    std::vector<SlowPair> result;
+    auto copy = heap;
+    while (!copy.empty()) {
+      result.push_back(copy.top());
+      copy.pop();
+    }
+    std::reverse(result.begin(), result.end());
+    return result;
+  }
+
+private:
+  unsigned capacity;
+  std::priority_queue<SlowPair, std::vector<SlowPair>, std::greater<SlowPair>>
+      heap;
+};
+
+// Latency histograms of the composite and the oracle, per input class
+class LatencyProfile {
+public:
+  LatencyProfile(unsigned bitWidth, unsigned slowestCount)
+      : bitWidth(bitWidth), slowestCount(slowestCount), composite((bitWidth + 1) * (bitWidth + 1)),
+        naive((bitWidth + 1) * (bitWidth + 1)),
+        slowestComposite(slowestCount), slowestNaive(slowestCount) {}
+
+  unsigned getBitWidth() const { return bitWidth; }
+  unsigned getSlowestCount() const { return slowestCount; }
+
+  void record(const KnownBits &lhs, const KnownBits &rhs,
+              uint64_t compositeLatency, uint64_t naiveLatency) {
+    unsigned cls = unknownBitCount(lhs) * (bitWidth + 1) + unknownBitCount(rhs);
+    composite[cls].record(compositeLatency);
+    naive[cls].record(naiveLatency);
+    slowestComposite.offer(compositeLatency, lhs, rhs);
+    slowestNaive.offer(naiveLatency, lhs, rhs);
+  }
+
+  LatencyProfile &operator+=(const LatencyProfile &other) {
+    for (size_t i = 0; i < composite.size(); i++) {
+      composite[i] += other.composite[i];
+      naive[i] += other.naive[i];
+    }
+    slowestComposite.merge(other.slowestComposite);
+    slowestNaive.merge(other.slowestNaive);
+    return *this;
+  }
+
+  void print(std::ostream &os) const {
+    char line[160];
+    auto row = [&](const char *label, const LatencyHistogram &c,
+                   const LatencyHistogram &n) {
+      std::snprintf(line, sizeof(line),
+                    "%-9s %10llu | %8llu %8llu %8llu %9llu | %8llu %8llu %8llu "
+                    "%9llu\n",
+                    label, static_cast<unsigned long long>(c.count()),
+                    static_cast<unsigned long long>(c.percentile(50)),
+                    static_cast<unsigned long long>(c.percentile(99)),
+                    static_cast<unsigned long long>(c.percentile(99.9)),
+                    static_cast<unsigned long long>(c.max()),
+                    static_cast<unsigned long long>(n.percentile(50)),
+                    static_cast<unsigned long long>(n.percentile(99)),
+                    static_cast<unsigned long long>(n.percentile(99.9)),
+                    static_cast<unsigned long long>(n.max()));
+      os << line;
+    };
+
+    os << "Latency (ns) by unknown bits (lhs,rhs)" << std::endl;
+    std::snprintf(line, sizeof(line),
+                  "%-9s %10s | %8s %8s %8s %9s | %8s %8s %8s %9s\n", "Class",
+                  "Pairs", "comp p50", "p99", "p99.9", "max", "naive p50",
+                  "p99", "p99.9", "max");
+    os << line;
+
+    LatencyHistogram allComposite, allNaive;
+    for (unsigned l = 0; l <= bitWidth; l++) {
+      for (unsigned r = 0; r <= bitWidth; r++) {
+        unsigned cls = l * (bitWidth + 1) + r;
+        allComposite += composite[cls];
+        allNaive += naive[cls];
+        if (composite[cls].count() == 0)
+          continue;
+        char label[16];
+        std::snprintf(label, sizeof(label), "%u,%u", l, r);
+        row(label, composite[cls], naive[cls]);
+      }
+    }
+    row("all", allComposite, allNaive);
+
+    auto printSlowest = [&](const char *name, const SlowestPairs &slowest) {
+      os << "Slowest " << name << " pairs:" << std::endl;
+      for (const SlowPair &pair : slowest.sorted())
+        os << "  " << formatKnownBits(pair.lhs) << " "
+           << formatKnownBits(pair.rhs) << ": " << pair.latency << " ns"
+           << std::endl;
+    };
+    printSlowest("composite", slowestComposite);
+    printSlowest("naive", slowestNaive);
+    os << std::endl;
+  }
+
+private:
+  unsigned bitWidth;
+  unsigned slowestCount;
+  std::vector<LatencyHistogram> composite;
+  std::vector<LatencyHistogram> naive;
+  SlowestPairs slowestComposite;
+  SlowestPairs slowestNaive;
+};
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_HISTOGRAM_H
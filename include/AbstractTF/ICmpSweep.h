@@ -0,0 +1,318 @@
+// Exhaustive evaluation of LLVM's KnownBits comparison predicates.
+//
+// `KnownBits::eq`, `ult`, `slt` and friends return Optional<bool>: a value
+// when the comparison is decided by the known bits, None otherwise. The
+// oracle concretizes both operands and stops as soon as it has seen both
+// outcomes. A sweep reports how often the predicate is decided and how often
+// LLVM returns None on a decided pair.
+
+#ifndef ABSTRACTTF_ICMPSWEEP_H
+#define ABSTRACTTF_ICMPSWEEP_H
+
+#include "AbstractTF/Compare.h"
+#include "AbstractTF/FixedWidth.h"
+#include "AbstractTF/Parallel.h"
+#include "AbstractTF/Progress.h"
+#include "AbstractTF/Sweep.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/Optional.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/ErrorHandling.h>
+#include <llvm/Support/KnownBits.h>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace abstracttf {
+
+using llvm::KnownBits;
+
+enum class ICmpPredicate : uint8_t {
+  Eq,
+  Ne,
+  Ugt,
+  Uge,
+  Ult,
+  Ule,
+  Sgt,
+  Sge,
+  Slt,
+  Sle,
+};
+
+constexpr ICmpPredicate AllICmpPredicates[] = {
+    ICmpPredicate::Eq,  ICmpPredicate::Ne,  ICmpPredicate::Ugt,
+    ICmpPredicate::Uge, ICmpPredicate::Ult, ICmpPredicate::Ule,
+    ICmpPredicate::Sgt, ICmpPredicate::Sge, ICmpPredicate::Slt,
+    ICmpPredicate::Sle,
+};
+
+inline const char *icmpPredicateName(ICmpPredicate pred) {
+  switch (pred) {
+  case ICmpPredicate::Eq:
+    return "eq";
+  case ICmpPredicate::Ne:
+    return "ne";
+  case ICmpPredicate::Ugt:
+    return "ugt";
+  case ICmpPredicate::Uge:
+    return "uge";
+  case ICmpPredicate::Ult:
+    return "ult";
+  case ICmpPredicate::Ule:
+    return "ule";
+  case ICmpPredicate::Sgt:
+    return "sgt";
+  case ICmpPredicate::Sge:
+    return "sge";
+  case ICmpPredicate::Slt:
+    return "slt";
+  case ICmpPredicate::Sle:
+    return "sle";
+  }
+  llvm_unreachable("Unknown icmp predicate");
+}
+
+inline llvm::Optional<ICmpPredicate> parseICmpPredicate(llvm::StringRef name) {
+  for (ICmpPredicate pred : AllICmpPredicates)
+    if (name == icmpPredicateName(pred))
+      return pred;
+  return llvm::None;
+}
+
+// LLVM's transfer function for `pred`
+inline llvm::Optional<bool> compositeICmp(ICmpPredicate pred,
+                                          const KnownBits &lhs,
+                                          const KnownBits &rhs) {
+  switch (pred) {
+  case ICmpPredicate::Eq:
+    return KnownBits::eq(lhs, rhs);
+  case ICmpPredicate::Ne:
+    return KnownBits::ne(lhs, rhs);
+  case ICmpPredicate::Ugt:
+    return KnownBits::ugt(lhs, rhs);
+  case ICmpPredicate::Uge:
+    return KnownBits::uge(lhs, rhs);
+  case ICmpPredicate::Ult:
+    return KnownBits::ult(lhs, rhs);
+  case ICmpPredicate::Ule:
+    return KnownBits::ule(lhs, rhs);
+  case ICmpPredicate::Sgt:
+    return KnownBits::sgt(lhs, rhs);
+  case ICmpPredicate::Sge:
+    return KnownBits::sge(lhs, rhs);
+  case ICmpPredicate::Slt:
+    return KnownBits::slt(lhs, rhs);
+  case ICmpPredicate::Sle:
+    return KnownBits::sle(lhs, rhs);
+  }
+  llvm_unreachable("Unknown icmp predicate");
+}
+
+template <unsigned BW, ICmpPredicate Pred>
+constexpr bool fixedConcreteICmp(uint32_t lhs, uint32_t rhs) {
+  if constexpr (Pred == ICmpPredicate::Eq)
+    return lhs == rhs;
+  else if constexpr (Pred == ICmpPredicate::Ne)
+    return lhs != rhs;
+  else if constexpr (Pred == ICmpPredicate::Ugt)
+    return lhs > rhs;
+  else if constexpr (Pred == ICmpPredicate::Uge)
+    return lhs >= rhs;
+  else if constexpr (Pred == ICmpPredicate::Ult)
+    return lhs < rhs;
+  else if constexpr (Pred == ICmpPredicate::Ule)
+    return lhs <= rhs;
+  else if constexpr (Pred == ICmpPredicate::Sgt)
+    return fixedSext<BW>(lhs) > fixedSext<BW>(rhs);
+  else if constexpr (Pred == ICmpPredicate::Sge)
+    return fixedSext<BW>(lhs) >= fixedSext<BW>(rhs);
+  else if constexpr (Pred == ICmpPredicate::Slt)
+    return fixedSext<BW>(lhs) < fixedSext<BW>(rhs);
+  else
+    return fixedSext<BW>(lhs) <= fixedSext<BW>(rhs);
+}
+
+// Call `fn(std::integral_constant<ICmpPredicate, Pred>())` for the runtime
+// `pred`
+template <typename Fn>
+inline void withICmpPredicate(ICmpPredicate pred, Fn &&fn) {
+#define ABSTRACTTF_ICMP_CASE(NAME)                                             \
+  case ICmpPredicate::NAME:                                                    \
+    return fn(std::integral_constant<ICmpPredicate, ICmpPredicate::NAME>());
+  switch (pred) {
+    ABSTRACTTF_ICMP_CASE(Eq)
+    ABSTRACTTF_ICMP_CASE(Ne)
+    ABSTRACTTF_ICMP_CASE(Ugt)
+    ABSTRACTTF_ICMP_CASE(Uge)
+    ABSTRACTTF_ICMP_CASE(Ult)
+    ABSTRACTTF_ICMP_CASE(Ule)
+    ABSTRACTTF_ICMP_CASE(Sgt)
+    ABSTRACTTF_ICMP_CASE(Sge)
+    ABSTRACTTF_ICMP_CASE(Slt)
+    ABSTRACTTF_ICMP_CASE(Sle)
+  }
+#undef ABSTRACTTF_ICMP_CASE
+  llvm_unreachable("Unknown icmp predicate");
+}
+
+// Exact outcome of `Pred` over the concretizations: a value if every pair
+// agrees, None as soon as both outcomes have been seen.
+template <unsigned BW, ICmpPredicate Pred>
+inline llvm::Optional<bool>
+fixedICmpOracle(llvm::ArrayRef<uint32_t> lhsValues,
+                llvm::ArrayRef<uint32_t> rhsValues) {
+  bool first = fixedConcreteICmp<BW, Pred>(lhsValues[0], rhsValues[0]);
+  for (uint32_t cLhs : lhsValues)
+    for (uint32_t cRhs : rhsValues)
+      if (fixedConcreteICmp<BW, Pred>(cLhs, cRhs) != first)
+        return llvm::None;
+  return first;
+}
+
+// Where a decided predicate is "more precise" than None. Deciding a pair
+// the oracle leaves open, or deciding it the other way, is unsound.
+inline PrecisionOrder compareICmp(llvm::Optional<bool> composite,
+                                  llvm::Optional<bool> oracle) {
+  if (composite == oracle)
+    return PrecisionOrder::Same;
+  if (!composite)
+    return PrecisionOrder::SecondMorePrecise;
+  if (!oracle)
+    return PrecisionOrder::FirstMorePrecise;
+  return PrecisionOrder::Incomparable;
+}
+
+struct ICmpSweepResult {
+  unsigned bitWidth = 0;
+  uint64_t totalKnownBits = 0;
+  PrecisionCounts counts;
+  uint64_t oracleDecided = 0;
+  uint64_t compositeDecided = 0;
+  double totalTimeComposite = 0.0; // nanoseconds
+  double totalTimeNaive = 0.0;     // nanoseconds
+
+  uint64_t totalPairs() const { return totalKnownBits * totalKnownBits; }
+
+  ICmpSweepResult &operator+=(const ICmpSweepResult &other) {
+    counts += other.counts;
+    oracleDecided += other.oracleDecided;
+    compositeDecided += other.compositeDecided;
+    totalTimeComposite += other.totalTimeComposite;
+    totalTimeNaive += other.totalTimeNaive;
+    return *this;
+  }
+};
+
+using ICmpSweepWorker = BasicSweepWorker<ICmpSweepResult>;
+
+// Returns one ICmpSweepResult per entry of `preds`, in order. Operands are
+// concretized once per pair and shared by all predicates.
+template <unsigned BW>
+inline std::vector<ICmpSweepResult>
+sweepICmpFixedWidth(const std::vector<ICmpPredicate> &preds,
+                    const SweepOptions &options) {
+  std::vector<FixedKnownBits<BW>> allFixed = enumerateFixedWidth<BW>();
+  std::vector<KnownBits> allKnownBits;
+  allKnownBits.reserve(allFixed.size());
+  for (const FixedKnownBits<BW> &kb : allFixed)
+    allKnownBits.push_back(kb.toKnownBits());
+
+  auto concretize = [](FixedKnownBits<BW> kb, std::vector<uint32_t> &values) {
+    values.clear();
+    forEachFixedConcretization(kb, [&](uint32_t v) { values.push_back(v); });
+  };
+
+  std::vector<ICmpSweepResult> results(preds.size());
+  auto rowCost = [&](size_t i) {
+    return pairRowCost(__builtin_popcount(allFixed[i].unknown()));
+  };
+  runMultiSweepRows(allFixed.size(), rowCost, options, results,
+                    [&](size_t i, ICmpSweepWorker *workers) {
+    thread_local std::vector<uint32_t> lhsValues, rhsValues;
+    concretize(allFixed[i], lhsValues);
+    for (size_t j = 0; j < allFixed.size(); j++) {
+      concretize(allFixed[j], rhsValues);
+      for (size_t k = 0; k < preds.size(); k++) {
+        ICmpSweepWorker &worker = workers[k];
+        auto t1 = std::chrono::high_resolution_clock::now();
+        llvm::Optional<bool> composite =
+            compositeICmp(preds[k], allKnownBits[i], allKnownBits[j]);
+        auto t2 = std::chrono::high_resolution_clock::now();
+        double timeComposite = (t2 - t1).count();
+
+        llvm::Optional<bool> oracle;
+        t1 = std::chrono::high_resolution_clock::now();
+        withICmpPredicate(preds[k], [&](auto pred) {
+          oracle = fixedICmpOracle<BW, decltype(pred)::value>(lhsValues,
+                                                              rhsValues);
+        });
+        t2 = std::chrono::high_resolution_clock::now();
+        double timeNaive = (t2 - t1).count();
+
+        worker.record(allKnownBits[i], allKnownBits[j],
+                      compareICmp(composite, oracle), timeComposite,
+                      timeNaive);
+        worker.partial.oracleDecided += oracle.hasValue();
+        worker.partial.compositeDecided += composite.hasValue();
+      }
+    }
+  });
+
+  for (ICmpSweepResult &result : results) {
+    result.bitWidth = BW;
+    result.totalKnownBits = allFixed.size();
+  }
+  return results;
+}
+
+using ICmpSweepFn = std::vector<ICmpSweepResult> (*)(
+    const std::vector<ICmpPredicate> &, const SweepOptions &);
+
+template <size_t... Is>
+constexpr std::array<ICmpSweepFn, sizeof...(Is) + 1>
+makeICmpSweepTable(std::index_sequence<Is...>) {
+  return {nullptr, &sweepICmpFixedWidth<Is + 1>...};
+}
+
+// Returns the fixed-width icmp sweep for `bitWidth`, or nullptr if the
+// width has no specialization.
+inline ICmpSweepFn getICmpFixedWidthSweep(unsigned bitWidth) {
+  static constexpr std::array<ICmpSweepFn, MaxFixedBitWidth + 1> Table =
+      makeICmpSweepTable(std::make_index_sequence<MaxFixedBitWidth>());
+  if (bitWidth == 0 || bitWidth > MaxFixedBitWidth)
+    return nullptr;
+  return Table[bitWidth];
+}
+
+inline void printICmpSweepResult(std::ostream &os, const char *predName,
+                                 const ICmpSweepResult &result) {
+  uint64_t missed = result.counts.naiveMorePrecise;
+  os << "Testing icmp " << predName << " for BitWidth = " << result.bitWidth
+     << std::endl;
+  os << "Total abstract values: " << result.totalKnownBits << std::endl;
+  os << "Pairs decided by the oracle: " << result.oracleDecided << " of "
+     << result.totalPairs() << std::endl;
+  os << "Pairs decided by LLVM: " << result.compositeDecided << std::endl;
+  os << "LLVM returned None on decided pairs: " << missed << " ("
+     << (result.oracleDecided ? 100.0 * missed / result.oracleDecided : 0.0)
+     << "% of decided)" << std::endl;
+  os << "LLVM decided an undecided pair: "
+     << result.counts.compositeMorePrecise << std::endl;
+  os << "LLVM decided the wrong way: " << result.counts.incomparableResults
+     << std::endl;
+  os << "Average composite time: "
+     << result.totalTimeComposite / result.totalPairs() << std::endl;
+  os << "Average naive time: " << result.totalTimeNaive / result.totalPairs()
+     << std::endl
+     << std::endl;
+}
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_ICMPSWEEP_H
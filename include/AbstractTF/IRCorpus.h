@@ -0,0 +1,47 @@
+// Discovery of signed high-half multiply idioms in LLVM IR modules.
+
+#ifndef ABSTRACTTF_IRCORPUS_H
+#define ABSTRACTTF_IRCORPUS_H
+
+#include <llvm/Support/KnownBits.h>
+#include <string>
+#include <vector>
+
+namespace llvm {
+class Module;
+} // namespace llvm
+
+namespace abstracttf {
+
+using llvm::KnownBits;
+
+// One occurrence of
+//   trunc(lshr/ashr(mul(sext(a), sext(b)), bw)) to iBW
+// with the known bits of `a` and `b` at that point of the program.
+struct MulhsSite {
+  std::string moduleName;
+  std::string functionName;
+  KnownBits lhs;
+  KnownBits rhs;
+
+  unsigned getBitWidth() const { return lhs.getBitWidth(); }
+};
+
+// Append every mulhs idiom in `module` to `sites`.
+void findMulhsSites(const llvm::Module &module, std::vector<MulhsSite> &sites);
+
+struct CorpusScanResult {
+  std::vector<MulhsSite> sites;
+  std::vector<std::string> errors; // One entry per file that failed to parse
+  unsigned modulesParsed = 0;
+};
+
+// Parse each .ll/.bc file in `files` (in its own LLVMContext, on up to
+// `numThreads` threads) and collect the mulhs idioms of all of them. Sites
+// are returned grouped by file in the order of `files`.
+CorpusScanResult scanCorpus(const std::vector<std::string> &files,
+                            unsigned numThreads);
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_IRCORPUS_H
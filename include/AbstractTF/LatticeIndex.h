@@ -0,0 +1,196 @@
+// Navigation over the rank space of `enumerateFromBitWidth`.
+//
+// Rank r encodes a KnownBits value as base-3 digits, digit i describing bit
+// i (0 = known zero, 1 = known one, 2 = unknown). Moving along a single-bit
+// edge of the lattice therefore only touches one digit: refining unknown
+// bit i to 0 or 1 subtracts 2 * 3^i or 3^i from the rank, and generalizing
+// a known bit adds it back. Conversions between ranks and (Zero, One) masks
+// go eight digits at a time through two small tables, and the values with k
+// unknown bits are generated directly rather than filtered out of all 3^BW.
+
+#ifndef ABSTRACTTF_LATTICEINDEX_H
+#define ABSTRACTTF_LATTICEINDEX_H
+
+#include "AbstractTF/Enumeration.h"
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+
+namespace abstracttf {
+
+// (Zero, One) masks of a rank
+struct RankMasks {
+  uint32_t Zero = 0;
+  uint32_t One = 0;
+};
+
+class LatticeIndex {
+public:
+  // Ranks of every width up to 32 bits fit in 64 bits (3^32 < 2^51)
+  static constexpr unsigned MaxBitWidth = 32;
+
+  explicit LatticeIndex(unsigned bitWidth) : BitWidth(bitWidth) {
+    assert(bitWidth >= 1 && bitWidth <= MaxBitWidth && "Unsupported width");
+    Mask = bitWidth == 32 ? ~uint32_t(0) : (uint32_t(1) << bitWidth) - 1;
+    uint64_t weight = 1;
+    for (unsigned bit = 0; bit <= MaxBitWidth; bit++, weight *= 3)
+      Pow3[bit] = weight;
+  }
+
+  unsigned getBitWidth() const { return BitWidth; }
+  uint64_t size() const { return Pow3[BitWidth]; }
+
+  // Rank distance of digit `bit`: 3^bit
+  uint64_t digitWeight(unsigned bit) const { return Pow3[bit]; }
+
+  uint64_t rankOf(uint32_t zero, uint32_t one) const {
+    uint32_t unknown = ~(zero | one) & Mask;
+    return spreadRank(one) + 2 * spreadRank(unknown);
+  }
+
+  RankMasks masksOf(uint64_t rank) const {
+    const Tables &tables = getTables();
+    uint32_t one = 0, unknown = 0;
+    for (unsigned shift = 0; shift < BitWidth; shift += 8) {
+      const DigitMasks &digits = tables.Digits[rank % ChunkRanks];
+      rank /= ChunkRanks;
+      one |= uint32_t(digits.One) << shift;
+      unknown |= uint32_t(digits.Unknown) << shift;
+    }
+    return {~(one | unknown) & Mask, one};
+  }
+
+  uint32_t unknownMask(uint64_t rank) const {
+    RankMasks masks = masksOf(rank);
+    return ~(masks.Zero | masks.One) & Mask;
+  }
+
+  // Number of unknown bits, the level of `rank` in the lattice
+  unsigned level(uint64_t rank) const {
+    return __builtin_popcount(unknownMask(rank));
+  }
+
+  // Unknown bit `bit` of `rank` refined to `value`
+  uint64_t childRank(uint64_t rank, unsigned bit, bool value) const {
+    return rank - (value ? 1 : 2) * Pow3[bit];
+  }
+
+  // Known bit `bit` of `rank`, currently `value`, made unknown
+  uint64_t parentRank(uint64_t rank, unsigned bit, bool value) const {
+    return rank + (value ? 1 : 2) * Pow3[bit];
+  }
+
+  // Call `fn(childRank, bit)` for both refinements of every unknown bit
+  template <typename Fn> void forEachChild(uint64_t rank, Fn &&fn) const {
+    forEachChild(rank, unknownMask(rank), fn);
+  }
+
+  // Same, when the caller already has the unknown mask of `rank`
+  template <typename Fn>
+  void forEachChild(uint64_t rank, uint32_t unknown, Fn &&fn) const {
+    for (; unknown; unknown &= unknown - 1) {
+      unsigned bit = __builtin_ctz(unknown);
+      fn(rank - 2 * Pow3[bit], bit);
+      fn(rank - Pow3[bit], bit);
+    }
+  }
+
+  // Call `fn(parentRank, bit)` for every known bit
+  template <typename Fn> void forEachParent(uint64_t rank, Fn &&fn) const {
+    RankMasks masks = masksOf(rank);
+    for (uint32_t zero = masks.Zero; zero; zero &= zero - 1) {
+      unsigned bit = __builtin_ctz(zero);
+      fn(rank + 2 * Pow3[bit], bit);
+    }
+    for (uint32_t one = masks.One; one; one &= one - 1) {
+      unsigned bit = __builtin_ctz(one);
+      fn(rank + Pow3[bit], bit);
+    }
+  }
+
+  // C(BitWidth, k) * 2^(BitWidth - k) values have k unknown bits
+  uint64_t levelSize(unsigned k) const {
+    uint64_t choose = 1;
+    for (unsigned i = 0; i < k; i++)
+      choose = choose * (BitWidth - i) / (i + 1);
+    return choose << (BitWidth - k);
+  }
+
+  // Call `fn(rank, unknownMask)` for every value with exactly k unknown
+  // bits. Unknown positions are walked in increasing mask order, the known
+  // bits as subsets of the remaining positions.
+  template <typename Fn> void forEachAtLevel(unsigned k, Fn &&fn) const {
+    assert(k <= BitWidth && "Level out of range");
+    uint64_t limit = uint64_t(1) << BitWidth;
+    for (uint64_t unknown = (uint64_t(1) << k) - 1; unknown < limit;) {
+      uint32_t known = ~uint32_t(unknown) & Mask;
+      uint64_t base = 2 * spreadRank(uint32_t(unknown));
+      uint32_t ones = 0;
+      do {
+        fn(base + spreadRank(ones), uint32_t(unknown));
+        ones = (ones - known) & known;
+      } while (ones != 0);
+      if (k == 0)
+        break;
+      // Next mask with the same popcount (Gosper's hack)
+      uint64_t lowest = unknown & -unknown;
+      uint64_t ripple = unknown + lowest;
+      unknown = (((ripple ^ unknown) >> 2) / lowest) | ripple;
+    }
+  }
+
+private:
+  static constexpr unsigned ChunkRanks = 6561; // 3^8
+
+  struct DigitMasks {
+    uint8_t One = 0;
+    uint8_t Unknown = 0;
+  };
+
+  struct Tables {
+    // Spread[m] = sum of 3^i over the set bits i of m
+    std::array<uint16_t, 256> Spread;
+    // Digits[r] = masks of the 8-digit rank r
+    std::array<DigitMasks, ChunkRanks> Digits;
+  };
+
+  static const Tables &getTables() {
+    static const Tables tables = [] {
+      Tables t;
+      for (unsigned m = 0; m < 256; m++) {
+        unsigned spread = 0, weight = 1;
+        for (unsigned bit = 0; bit < 8; bit++, weight *= 3)
+          spread += (m >> bit & 1) * weight;
+        t.Spread[m] = spread;
+      }
+      for (unsigned r = 0; r < ChunkRanks; r++) {
+        DigitMasks digits;
+        for (unsigned bit = 0, rest = r; bit < 8; bit++, rest /= 3) {
+          digits.One |= (rest % 3 == 1) << bit;
+          digits.Unknown |= (rest % 3 == 2) << bit;
+        }
+        t.Digits[r] = digits;
+      }
+      return t;
+    }();
+    return tables;
+  }
+
+  // Sum of 3^i over the set bits of `bits`
+  uint64_t spreadRank(uint32_t bits) const {
+    const Tables &tables = getTables();
+    uint64_t rank = 0;
+    for (unsigned shift = 0; shift < BitWidth; shift += 8)
+      rank += tables.Spread[uint8_t(bits >> shift)] * Pow3[shift];
+    return rank;
+  }
+
+  unsigned BitWidth;
+  uint32_t Mask;
+  std::array<uint64_t, MaxBitWidth + 1> Pow3;
+};
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_LATTICEINDEX_H
@@ -0,0 +1,195 @@
+// Monotonicity check for KnownBits transfer functions.
+//
+// f is monotone if f(a, b) ⊑ f(a', b') whenever a ⊑ a' and b ⊑ b', where
+// x ⊑ y means y knows at least the bits x knows. Any such refinement is a
+// chain of single-bit steps (one unknown digit becomes 0 or 1, on one
+// operand at a time), and ⊑ is transitive, so it is enough to check every
+// single-bit edge of the 3^BW x 3^BW lattice, which LatticeIndex reaches
+// by O(1) rank arithmetic. All composite results of a width are computed
+// once into a table and each pair is compared against its children from
+// it, so the check costs one sweep of composite calls plus a few table
+// lookups per pair.
+
+#ifndef ABSTRACTTF_MONOTONICITY_H
+#define ABSTRACTTF_MONOTONICITY_H
+
+#include "AbstractTF/BinaryOps.h"
+#include "AbstractTF/Enumeration.h"
+#include "AbstractTF/FixedWidth.h"
+#include "AbstractTF/Format.h"
+#include "AbstractTF/LatticeIndex.h"
+#include "AbstractTF/Parallel.h"
+#include "AbstractTF/Progress.h"
+#include "AbstractTF/Sweep.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <llvm/Support/KnownBits.h>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace abstracttf {
+
+using llvm::KnownBits;
+
+// Widest width checked: the result table holds 9^BW entries of two bytes.
+constexpr unsigned MaxMonotoneBitWidth = 8;
+
+// One single-bit edge where refining an operand lost precision
+struct MonotonicityViolation {
+  KnownBits lhs, rhs;       // The more general operands
+  KnownBits refinedLhs, refinedRhs;
+  KnownBits result, refinedResult;
+};
+
+struct MonotonicityResult {
+  unsigned bitWidth = 0;
+  uint64_t pairs = 0;
+  uint64_t edges = 0;
+  uint64_t lhsViolations = 0; // Edges refining the left operand
+  uint64_t rhsViolations = 0; // Edges refining the right operand
+  std::vector<MonotonicityViolation> examples;
+  double tableTime = 0.0; // seconds
+  double checkTime = 0.0; // seconds
+
+  uint64_t violations() const { return lhsViolations + rhsViolations; }
+};
+
+// `refined` is at least as precise as `general`, or bottom
+inline bool refinesPacked(PackedKnownBits general, PackedKnownBits refined) {
+  if (refined.Zero & refined.One)
+    return true;
+  return (general.Zero & ~refined.Zero) == 0 &&
+         (general.One & ~refined.One) == 0;
+}
+
+// Check every single-bit refinement edge of `op` at width BW. Up to
+// `maxExamples` violations are kept for the report.
+template <unsigned BW>
+inline MonotonicityResult checkMonotonicity(BinaryOp op,
+                                            const SweepOptions &options,
+                                            size_t maxExamples) {
+  static_assert(BW <= MaxMonotoneBitWidth, "Result table would not fit");
+  const uint64_t n = numKnownBits(BW);
+  std::vector<KnownBits> allKnownBits = enumerateFromBitWidth(BW);
+  std::vector<PackedKnownBits> table(n * n);
+  unsigned numThreads = std::max(1u, options.numThreads);
+  SweepCounters threadCounters(options);
+
+  auto tableStart = std::chrono::steady_clock::now();
+  parallelFor(n, numThreads, [&](size_t i, unsigned thread) {
+    WorkerCounters &counters = threadCounters[thread];
+    for (uint64_t j = 0; j < n; j++) {
+      KnownBits result =
+          compositeBinaryOp(op, allKnownBits[i], allKnownBits[j]);
+      table[i * n + j] = {uint8_t(result.Zero.getZExtValue()),
+                          uint8_t(result.One.getZExtValue())};
+      counters.skip();
+    }
+  });
+  auto checkStart = std::chrono::steady_clock::now();
+
+  LatticeIndex lattice(BW);
+  std::vector<uint32_t> unknownOf(n);
+  for (uint64_t rank = 0; rank < n; rank++)
+    unknownOf[rank] = lattice.unknownMask(rank);
+
+  std::vector<MonotonicityResult> partials(numThreads);
+  parallelFor(n, numThreads, [&](size_t i, unsigned thread) {
+    WorkerCounters &counters = threadCounters[thread];
+    MonotonicityResult &partial = partials[thread];
+    auto record = [&](uint64_t lhs, uint64_t rhs, uint64_t refinedLhs,
+                      uint64_t refinedRhs, uint64_t &violations) {
+      partial.edges++;
+      PackedKnownBits general = table[lhs * n + rhs];
+      PackedKnownBits refined = table[refinedLhs * n + refinedRhs];
+      if (refinesPacked(general, refined))
+        return;
+      violations++;
+      if (partial.examples.size() < maxExamples)
+        partial.examples.push_back(
+            {allKnownBits[lhs], allKnownBits[rhs], allKnownBits[refinedLhs],
+             allKnownBits[refinedRhs],
+             compositeBinaryOp(op, allKnownBits[lhs], allKnownBits[rhs]),
+             compositeBinaryOp(op, allKnownBits[refinedLhs],
+                               allKnownBits[refinedRhs])});
+    };
+
+    for (uint64_t j = 0; j < n; j++) {
+      lattice.forEachChild(i, unknownOf[i], [&](uint64_t child, unsigned) {
+        record(i, j, child, j, partial.lhsViolations);
+      });
+      lattice.forEachChild(j, unknownOf[j], [&](uint64_t child, unsigned) {
+        record(i, j, i, child, partial.rhsViolations);
+      });
+      counters.skip();
+    }
+  });
+  auto checkEnd = std::chrono::steady_clock::now();
+
+  MonotonicityResult result;
+  result.bitWidth = BW;
+  result.pairs = n * n;
+  for (MonotonicityResult &partial : partials) {
+    result.edges += partial.edges;
+    result.lhsViolations += partial.lhsViolations;
+    result.rhsViolations += partial.rhsViolations;
+    for (MonotonicityViolation &example : partial.examples)
+      if (result.examples.size() < maxExamples)
+        result.examples.push_back(std::move(example));
+  }
+  result.tableTime =
+      std::chrono::duration<double>(checkStart - tableStart).count();
+  result.checkTime =
+      std::chrono::duration<double>(checkEnd - checkStart).count();
+  return result;
+}
+
+using MonotonicityCheckFn = MonotonicityResult (*)(BinaryOp,
+                                                   const SweepOptions &,
+                                                   size_t);
+
+template <size_t... Is>
+constexpr std::array<MonotonicityCheckFn, sizeof...(Is) + 1>
+makeMonotonicityTable(std::index_sequence<Is...>) {
+  return {nullptr, &checkMonotonicity<Is + 1>...};
+}
+
+// Returns the monotonicity check for `bitWidth`, or nullptr if the width is
+// out of reach.
+inline MonotonicityCheckFn getMonotonicityCheck(unsigned bitWidth) {
+  static constexpr std::array<MonotonicityCheckFn, MaxMonotoneBitWidth + 1>
+      Table = makeMonotonicityTable(
+          std::make_index_sequence<MaxMonotoneBitWidth>());
+  if (bitWidth == 0 || bitWidth > MaxMonotoneBitWidth)
+    return nullptr;
+  return Table[bitWidth];
+}
+
+inline void printMonotonicityResult(std::ostream &os, const char *opName,
+                                    const MonotonicityResult &result) {
+  os << "Checking monotonicity of " << opName
+     << " for BitWidth = " << result.bitWidth << std::endl;
+  os << "Pairs: " << result.pairs << std::endl;
+  os << "Single-bit refinement edges: " << result.edges << std::endl;
+  os << "Violations refining the left operand: " << result.lhsViolations
+     << std::endl;
+  os << "Violations refining the right operand: " << result.rhsViolations
+     << std::endl;
+  for (const MonotonicityViolation &v : result.examples)
+    os << "  " << opName << "(" << formatKnownBits(v.lhs) << ", "
+       << formatKnownBits(v.rhs) << ") = " << formatKnownBits(v.result)
+       << " but " << opName << "(" << formatKnownBits(v.refinedLhs) << ", "
+       << formatKnownBits(v.refinedRhs)
+       << ") = " << formatKnownBits(v.refinedResult) << std::endl;
+  os << "Composite table time: " << result.tableTime << " s" << std::endl;
+  os << "Edge check time: " << result.checkTime << " s" << std::endl
+     << std::endl;
+}
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_MONOTONICITY_H
@@ -0,0 +1,172 @@
+// Alternative KnownBits multiplication algorithms, each adapted to the
+// signed high half so it can stand in for KnownBits::mulhs.
+//
+// The low-half algorithms run on the operands sign-extended to 2 * bw bits:
+// the product of those is the exact signed product, so bits [bw, 2 * bw) of
+// a sound 2 * bw bit multiply are a sound mulhs.
+//
+//   tnum          eBPF verifier tnum_mul (Linux 5.19+): known-value product
+//                 plus one tnum_add of uncertainty per multiplier bit
+//   tnum-legacy   the older eBPF tnum_mul built from two hma() passes
+//   partial       schoolbook sum of bw partial products with
+//                 KnownBits::computeForAddSub, the top one subtracted
+//   range         signed ConstantRange multiply, high bits read back as the
+//                 common prefix of the result range
+//   combined      every known bit any of the above (or LLVM) proves
+
+#ifndef ABSTRACTTF_MULHSALGORITHMS_H
+#define ABSTRACTTF_MULHSALGORITHMS_H
+
+#include "AbstractTF/MulhsOracle.h"
+#include "AbstractTF/RangeDomain.h"
+
+#include <llvm/ADT/APInt.h>
+#include <llvm/IR/ConstantRange.h>
+#include <llvm/Support/KnownBits.h>
+
+namespace abstracttf {
+
+using llvm::APInt;
+using llvm::ConstantRange;
+using llvm::KnownBits;
+
+// KnownBits as the eBPF verifier's tristate number: Value holds the known
+// ones, Mask the unknown bits.
+struct Tnum {
+  APInt Value;
+  APInt Mask;
+
+  static Tnum fromKnownBits(const KnownBits &kb) {
+    return {kb.One, ~(kb.Zero | kb.One)};
+  }
+
+  KnownBits toKnownBits() const {
+    KnownBits kb(Value.getBitWidth());
+    kb.One = Value;
+    kb.Zero = ~(Value | Mask);
+    return kb;
+  }
+};
+
+inline Tnum tnumAdd(const Tnum &a, const Tnum &b) {
+  APInt sm = a.Mask + b.Mask;
+  APInt sv = a.Value + b.Value;
+  APInt sigma = sm + sv;
+  APInt chi = sigma ^ sv;
+  APInt mu = chi | a.Mask | b.Mask;
+  return {sv & ~mu, mu};
+}
+
+inline Tnum tnumMul(Tnum a, Tnum b) {
+  unsigned bw = a.Value.getBitWidth();
+  APInt accValue = a.Value * b.Value;
+  Tnum accMask{APInt(bw, 0), APInt(bw, 0)};
+  while (!a.Value.isZero() || !a.Mask.isZero()) {
+    if (a.Value[0])
+      accMask = tnumAdd(accMask, {APInt(bw, 0), b.Mask});
+    else if (a.Mask[0])
+      accMask = tnumAdd(accMask, {APInt(bw, 0), b.Value | b.Mask});
+    a.Value.lshrInPlace(1);
+    a.Mask.lshrInPlace(1);
+    b.Value <<= 1;
+    b.Mask <<= 1;
+  }
+  return tnumAdd({accValue, APInt(bw, 0)}, accMask);
+}
+
+// hma() of the pre-5.19 kernel: add `value` shifted to every set bit of
+// `mask` as pure uncertainty
+inline Tnum tnumHma(Tnum acc, APInt value, APInt mask) {
+  unsigned bw = value.getBitWidth();
+  while (!mask.isZero()) {
+    if (mask[0])
+      acc = tnumAdd(acc, {APInt(bw, 0), value});
+    mask.lshrInPlace(1);
+    value <<= 1;
+  }
+  return acc;
+}
+
+inline Tnum tnumMulLegacy(const Tnum &a, const Tnum &b) {
+  unsigned bw = a.Value.getBitWidth();
+  Tnum acc = tnumHma({a.Value * b.Value, APInt(bw, 0)}, a.Mask,
+                     b.Mask | b.Value);
+  return tnumHma(acc, b.Mask, a.Value);
+}
+
+inline KnownBits tnumMulhs(const KnownBits &lhs, const KnownBits &rhs) {
+  unsigned bw = lhs.getBitWidth();
+  Tnum product = tnumMul(Tnum::fromKnownBits(lhs.sext(2 * bw)),
+                         Tnum::fromKnownBits(rhs.sext(2 * bw)));
+  return product.toKnownBits().extractBits(bw, bw);
+}
+
+inline KnownBits tnumLegacyMulhs(const KnownBits &lhs, const KnownBits &rhs) {
+  unsigned bw = lhs.getBitWidth();
+  Tnum product = tnumMulLegacy(Tnum::fromKnownBits(lhs.sext(2 * bw)),
+                               Tnum::fromKnownBits(rhs.sext(2 * bw)));
+  return product.toKnownBits().extractBits(bw, bw);
+}
+
+// lhs = -l[bw-1] * 2^(bw-1) + sum of l[i] * 2^i, so the product is the sum
+// of rhs << i over the low bits minus rhs << (bw - 1) for the sign bit. A
+// partial product whose multiplier bit is unknown keeps only the zeros of
+// the shifted multiplicand.
+inline KnownBits partialProductMulhs(const KnownBits &lhs,
+                                     const KnownBits &rhs) {
+  unsigned bw = lhs.getBitWidth();
+  KnownBits wideRhs = rhs.sext(2 * bw);
+  KnownBits acc = KnownBits::makeConstant(APInt(2 * bw, 0));
+  for (unsigned i = 0; i < bw; i++) {
+    if (lhs.Zero[i])
+      continue;
+    KnownBits partial(2 * bw);
+    partial.Zero = wideRhs.Zero.shl(i);
+    partial.Zero.setLowBits(i);
+    if (lhs.One[i])
+      partial.One = wideRhs.One.shl(i);
+    acc = KnownBits::computeForAddSub(/*Add=*/i != bw - 1, /*NSW=*/false, acc,
+                                      partial);
+  }
+  return acc.extractBits(bw, bw);
+}
+
+inline KnownBits rangeMulhs(const KnownBits &lhs, const KnownBits &rhs) {
+  unsigned bw = lhs.getBitWidth();
+  ConstantRange lhsRange = ConstantRange::fromKnownBits(lhs, /*IsSigned=*/true);
+  ConstantRange rhsRange = ConstantRange::fromKnownBits(rhs, /*IsSigned=*/true);
+  ConstantRange high = lhsRange.signExtend(2 * bw)
+                           .multiply(rhsRange.signExtend(2 * bw))
+                           .ashr(ConstantRange(APInt(2 * bw, bw)))
+                           .truncate(bw);
+  return rangeToKnownBits(high);
+}
+
+inline KnownBits combinedMulhs(const KnownBits &lhs, const KnownBits &rhs) {
+  KnownBits result = KnownBits::mulhs(lhs, rhs);
+  for (const KnownBits &other :
+       {tnumMulhs(lhs, rhs), tnumLegacyMulhs(lhs, rhs),
+        partialProductMulhs(lhs, rhs), rangeMulhs(lhs, rhs)}) {
+    result.Zero |= other.Zero;
+    result.One |= other.One;
+  }
+  return result;
+}
+
+struct MulhsAlgorithm {
+  const char *name;
+  KnownBitsBinaryFn fn;
+};
+
+constexpr MulhsAlgorithm AllMulhsAlgorithms[] = {
+    {"llvm", KnownBits::mulhs},
+    {"tnum", tnumMulhs},
+    {"tnum-legacy", tnumLegacyMulhs},
+    {"partial", partialProductMulhs},
+    {"range", rangeMulhs},
+    {"combined", combinedMulhs},
+};
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_MULHSALGORITHMS_H
@@ -0,0 +1,153 @@
+// Exact mulhs for a single query, using the fastest available kernel for
+// the query's bit width.
+
+#ifndef ABSTRACTTF_MULHSORACLE_H
+#define ABSTRACTTF_MULHSORACLE_H
+
+#include "AbstractTF/BranchAndBound.h"
+#include "AbstractTF/Compare.h"
+#include "AbstractTF/FixedWidth.h"
+#include "AbstractTF/Oracle.h"
+#include "AbstractTF/WideInt.h"
+
+#include <array>
+#include <cstdint>
+#include <llvm/ADT/Optional.h>
+#include <llvm/Support/KnownBits.h>
+#include <utility>
+
+namespace abstracttf {
+
+using llvm::KnownBits;
+
+// Queries whose operands have more unknown bits than this in total are too
+// expensive for the enumerating oracle (2^24 concrete products).
+constexpr unsigned DefaultOracleUnknownBudget = 24;
+
+using KnownBitsBinaryFn = KnownBits (*)(const KnownBits &, const KnownBits &);
+
+template <unsigned BW>
+inline KnownBits fixedNaiveMulhsKnownBits(const KnownBits &lhs,
+                                          const KnownBits &rhs) {
+  return fixedNaiveMulhs(FixedKnownBits<BW>::fromKnownBits(lhs),
+                         FixedKnownBits<BW>::fromKnownBits(rhs))
+      .toKnownBits();
+}
+
+// Optimal mulhs for widths up to 64 bits on plain machine words: operands
+// are concretized with a subset walk over the unknown mask and multiplied
+// as 128-bit integers, so nothing is allocated.
+inline KnownBits wordExactMulhs(const KnownBits &lhs, const KnownBits &rhs) {
+  unsigned bw = lhs.getBitWidth();
+  assert(bw >= 1 && bw <= 64 && bw == rhs.getBitWidth() &&
+         "Word oracle supports matching widths up to 64 bits");
+  const uint64_t mask = bw == 64 ? ~uint64_t(0) : (uint64_t(1) << bw) - 1;
+  const unsigned shift = 64 - bw;
+  const uint64_t lhsOne = lhs.One.getZExtValue();
+  const uint64_t rhsOne = rhs.One.getZExtValue();
+  const uint64_t lhsUnknown = ~(lhs.Zero.getZExtValue() | lhsOne) & mask;
+  const uint64_t rhsUnknown = ~(rhs.Zero.getZExtValue() | rhsOne) & mask;
+
+  uint64_t knownZero = mask;
+  uint64_t knownOne = mask;
+  uint64_t lhsSubset = 0;
+  do {
+    __int128 cLhs = static_cast<int64_t>((lhsOne | lhsSubset) << shift) >> shift;
+    uint64_t rhsSubset = 0;
+    do {
+      __int128 cRhs =
+          static_cast<int64_t>((rhsOne | rhsSubset) << shift) >> shift;
+      uint64_t value = static_cast<uint64_t>((cLhs * cRhs) >> bw) & mask;
+      knownZero &= ~value;
+      knownOne &= value;
+      rhsSubset = (rhsSubset - rhsUnknown) & rhsUnknown;
+    } while (rhsSubset != 0);
+    lhsSubset = (lhsSubset - lhsUnknown) & lhsUnknown;
+  } while (lhsSubset != 0);
+
+  KnownBits result(bw);
+  result.Zero = APInt(bw, knownZero);
+  result.One = APInt(bw, knownOne);
+  return result;
+}
+
+// Optimal mulhs for widths up to 64 * Words bits on stack-allocated
+// WideInts: the same subset walk as wordExactMulhs, with the products
+// formed in 2 * Words limbs.
+template <unsigned Words>
+inline KnownBits wideExactMulhs(const KnownBits &lhs, const KnownBits &rhs) {
+  using Word = WideInt<Words>;
+  using Product = WideInt<2 * Words>;
+  unsigned bw = lhs.getBitWidth();
+  assert(bw >= 1 && bw <= Word::MaxBitWidth && bw == rhs.getBitWidth() &&
+         "Operands too wide for the WideInt oracle");
+  const Word mask = Word::lowMask(bw);
+  const Word lhsOne = Word::fromAPInt(lhs.One);
+  const Word rhsOne = Word::fromAPInt(rhs.One);
+  const Word lhsUnknown = ~(Word::fromAPInt(lhs.Zero) | lhsOne) & mask;
+  const Word rhsUnknown = ~(Word::fromAPInt(rhs.Zero) | rhsOne) & mask;
+
+  Word knownZero = mask;
+  Word knownOne = mask;
+  Word lhsSubset;
+  do {
+    Product cLhs = (lhsOne | lhsSubset).template sext<2 * Words>(bw);
+    Word rhsSubset;
+    do {
+      Product cRhs = (rhsOne | rhsSubset).template sext<2 * Words>(bw);
+      Word value = (cLhs * cRhs).lshr(bw).template trunc<Words>() & mask;
+      knownZero &= ~value;
+      knownOne &= value;
+      rhsSubset = (rhsSubset - rhsUnknown) & rhsUnknown;
+    } while (!rhsSubset.isZero());
+    lhsSubset = (lhsSubset - lhsUnknown) & lhsUnknown;
+  } while (!lhsSubset.isZero());
+
+  KnownBits result(bw);
+  result.Zero = knownZero.toAPInt(bw);
+  result.One = knownOne.toAPInt(bw);
+  return result;
+}
+
+template <size_t... Is>
+constexpr std::array<KnownBitsBinaryFn, sizeof...(Is) + 1>
+makeMulhsOracleTable(std::index_sequence<Is...>) {
+  return {nullptr, &fixedNaiveMulhsKnownBits<Is + 1>...};
+}
+
+// Optimal mulhs of `lhs` and `rhs`. Cost is proportional to the product of
+// the operands' concretization sizes, so callers must bound the number of
+// unknown bits themselves.
+inline KnownBits exactMulhs(const KnownBits &lhs, const KnownBits &rhs) {
+  static constexpr std::array<KnownBitsBinaryFn, MaxFixedBitWidth + 1> Table =
+      makeMulhsOracleTable(std::make_index_sequence<MaxFixedBitWidth>());
+  unsigned bw = lhs.getBitWidth();
+  if (bw >= 1 && bw <= MaxFixedBitWidth)
+    return Table[bw](lhs, rhs);
+  if (bw <= 64)
+    return wordExactMulhs(lhs, rhs);
+  if (bw <= 128)
+    return wideExactMulhs<2>(lhs, rhs);
+  return naiveMulhs(lhs, rhs);
+}
+
+// Exact mulhs for any query within reach: enumeration while the operands
+// have at most DefaultOracleUnknownBudget unknown bits, branch and bound
+// beyond that for widths up to 64. Returns None when neither decides the
+// query.
+inline llvm::Optional<KnownBits> tryExactMulhs(const KnownBits &lhs,
+                                               const KnownBits &rhs) {
+  if (unknownBitCount(lhs) + unknownBitCount(rhs) <=
+      DefaultOracleUnknownBudget)
+    return exactMulhs(lhs, rhs);
+  if (lhs.getBitWidth() > 64)
+    return llvm::None;
+  BranchAndBoundResult bnb = branchAndBoundMulhs(lhs, rhs);
+  if (!bnb.exact)
+    return llvm::None;
+  return bnb.result;
+}
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_MULHSORACLE_H
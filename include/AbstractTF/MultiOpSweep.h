@@ -0,0 +1,123 @@
+// Exhaustive sweep of several binary operators over one shared enumeration.
+//
+// Each abstract pair is visited once: both operands are concretized into
+// per-thread buffers, and every operator's composite and oracle run against
+// those same buffers. Only the per-operator loops over the concrete values
+// are repeated, so adding operators costs their arithmetic and not another
+// traversal.
+
+#ifndef ABSTRACTTF_MULTIOPSWEEP_H
+#define ABSTRACTTF_MULTIOPSWEEP_H
+
+#include "AbstractTF/BinaryOps.h"
+#include "AbstractTF/FixedWidth.h"
+#include "AbstractTF/Sweep.h"
+
+#include <array>
+#include <chrono>
+#include <llvm/Support/KnownBits.h>
+#include <utility>
+#include <vector>
+
+namespace abstracttf {
+
+using llvm::KnownBits;
+
+// Returns one SweepResult per entry of `ops`, in order. Concretizing the
+// shared rhs operand is charged evenly to the operators' oracle time.
+template <unsigned BW>
+inline std::vector<SweepResult>
+sweepBinaryOpsFixedWidth(const std::vector<BinaryOp> &ops,
+                         const SweepOptions &options) {
+  std::vector<FixedKnownBits<BW>> allFixed = enumerateFixedWidth<BW>();
+  std::vector<KnownBits> allKnownBits;
+  allKnownBits.reserve(allFixed.size());
+  for (const FixedKnownBits<BW> &kb : allFixed)
+    allKnownBits.push_back(kb.toKnownBits());
+
+  std::vector<SweepResult> results(ops.size());
+  for (SweepResult &result : results) {
+    result.bitWidth = BW;
+    result.totalKnownBits = allFixed.size();
+  }
+
+  auto concretize = [](FixedKnownBits<BW> kb, std::vector<uint32_t> &values) {
+    values.clear();
+    forEachFixedConcretization(kb, [&](uint32_t v) { values.push_back(v); });
+  };
+
+  auto rowCost = [&](size_t i) {
+    return pairRowCost(__builtin_popcount(allFixed[i].unknown()));
+  };
+  runMultiSweepRows(allFixed.size(), rowCost, options, results,
+                    [&](size_t i, SweepWorker *workers) {
+    thread_local std::vector<uint32_t> lhsValues, rhsValues;
+    concretize(allFixed[i], lhsValues);
+    for (size_t j = 0; j < allFixed.size(); j++) {
+      auto t1 = std::chrono::high_resolution_clock::now();
+      concretize(allFixed[j], rhsValues);
+      auto t2 = std::chrono::high_resolution_clock::now();
+      double timeShared = double((t2 - t1).count()) / ops.size();
+
+      for (size_t k = 0; k < ops.size(); k++) {
+        SweepWorker &worker = workers[k];
+        KnownBits compositeResult;
+        llvm::Optional<FixedKnownBits<BW>> naiveResult;
+        double timeComposite, timeNaive;
+        {
+          AllocationScope scope(worker.partial.compositeAllocations);
+          auto t1 = std::chrono::high_resolution_clock::now();
+          compositeResult =
+              compositeBinaryOp(ops[k], allKnownBits[i], allKnownBits[j]);
+          auto t2 = std::chrono::high_resolution_clock::now();
+          timeComposite = (t2 - t1).count();
+        }
+        {
+          AllocationScope scope(worker.partial.naiveAllocations);
+          auto t1 = std::chrono::high_resolution_clock::now();
+          withBinaryOp(ops[k], [&](auto op) {
+            naiveResult = fixedOptimalBinaryOp<BW, decltype(op)::value>(
+                lhsValues, rhsValues);
+          });
+          auto t2 = std::chrono::high_resolution_clock::now();
+          timeNaive = (t2 - t1).count() + timeShared;
+        }
+
+        if (!naiveResult) {
+          worker.recordUndefined();
+          continue;
+        }
+        worker.record(allKnownBits[i], allKnownBits[j],
+                      comparePrecision(
+                          FixedKnownBits<BW>::fromKnownBits(compositeResult),
+                          *naiveResult),
+                      timeComposite, timeNaive);
+      }
+    }
+  });
+
+  return results;
+}
+
+using MultiOpSweepFn = std::vector<SweepResult> (*)(
+    const std::vector<BinaryOp> &, const SweepOptions &);
+
+template <size_t... Is>
+constexpr std::array<MultiOpSweepFn, sizeof...(Is) + 1>
+makeMultiOpSweepTable(std::index_sequence<Is...>) {
+  return {nullptr, &sweepBinaryOpsFixedWidth<Is + 1>...};
+}
+
+// Returns the fixed-width multi-operator sweep for `bitWidth`, or nullptr
+// if the width has no specialization.
+inline MultiOpSweepFn getMultiOpFixedWidthSweep(unsigned bitWidth) {
+  static constexpr std::array<MultiOpSweepFn, MaxFixedBitWidth + 1> Table =
+      makeMultiOpSweepTable(std::make_index_sequence<MaxFixedBitWidth>());
+  if (bitWidth == 0 || bitWidth > MaxFixedBitWidth)
+    return nullptr;
+  return Table[bitWidth];
+}
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_MULTIOPSWEEP_H
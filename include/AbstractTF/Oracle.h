@@ -0,0 +1,56 @@
+// Optimal ("naive") transfer functions computed by brute force: concretize
+// both operands, apply the concrete operation to every pair and abstract the
+// results.
+
+#ifndef ABSTRACTTF_ORACLE_H
+#define ABSTRACTTF_ORACLE_H
+
+#include "AbstractTF/Abstraction.h"
+#include "AbstractTF/Concretization.h"
+
+#include <cassert>
+#include <llvm/ADT/APInt.h>
+#include <llvm/Support/KnownBits.h>
+#include <vector>
+
+namespace abstracttf {
+
+using llvm::APInt;
+using llvm::KnownBits;
+
+// Signed high half of the 2 * bw bit product of `lhs` and `rhs`.
+inline APInt concreteMulhs(const APInt &lhs, const APInt &rhs) {
+  unsigned bw = lhs.getBitWidth();
+  APInt wideLhs = lhs.sext(2 * bw);
+  APInt wideRhs = rhs.sext(2 * bw);
+  APInt prod = wideLhs * wideRhs;
+  return prod.extractBits(bw, bw); // Extract bits starting at bw, length bw
+}
+
+// Optimal abstract transfer function for the binary operation `op`, which is
+// called as `op(const APInt &, const APInt &)` and returns an APInt.
+template <typename ConcreteOp>
+inline KnownBits optimalTransfer(const KnownBits &lhs, const KnownBits &rhs,
+                                 ConcreteOp &&op) {
+  assert(lhs.getBitWidth() == rhs.getBitWidth() &&
+         "RHS and LHS must have the same bitwidth");
+  std::vector<APInt> concreteLhs = concretization(lhs);
+  std::vector<APInt> concreteRhs = concretization(rhs);
+
+  std::vector<APInt> cfResult;
+  cfResult.reserve(concreteLhs.size() * concreteRhs.size());
+  for (const APInt &cLhs : concreteLhs) {
+    for (const APInt &cRhs : concreteRhs) {
+      cfResult.push_back(op(cLhs, cRhs));
+    }
+  }
+  return abstraction(cfResult);
+}
+
+inline KnownBits naiveMulhs(const KnownBits &lhs, const KnownBits &rhs) {
+  return optimalTransfer(lhs, rhs, concreteMulhs);
+}
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_ORACLE_H
@@ -0,0 +1,240 @@
+// Precomputed optimal mulhs results for every pair of one width.
+//
+// Entry lhsRank * 3^BW + rhsRank holds the oracle result for the pair with
+// those enumeration ranks as a PackedKnownBits, so a lookup is two rank
+// conversions through LatticeIndex and one load. Widths up to 8 fit
+// (9^8 entries, 86 MB). Tables are built with the fixed-width oracle and
+// can be saved to and loaded from a file in host byte order:
+//
+//   OracleTableHeader { "KBOT", version, op, bitWidth, numEntries }
+//   PackedKnownBits * numEntries
+
+#ifndef ABSTRACTTF_ORACLETABLE_H
+#define ABSTRACTTF_ORACLETABLE_H
+
+#include "AbstractTF/FixedWidth.h"
+#include "AbstractTF/LatticeIndex.h"
+#include "AbstractTF/Parallel.h"
+#include "AbstractTF/Progress.h"
+#include "AbstractTF/Sweep.h"
+#include "AbstractTF/Trace.h"
+
+#include <array>
+#include <chrono>
+#include <cassert>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <llvm/ADT/APInt.h>
+#include <llvm/Support/KnownBits.h>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace abstracttf {
+
+using llvm::APInt;
+using llvm::KnownBits;
+
+// Widest table: 9^BW entries of two bytes.
+constexpr unsigned MaxOracleTableBitWidth = 8;
+constexpr uint32_t OracleTableVersion = 1;
+
+struct OracleTableHeader {
+  char magic[4] = {'K', 'B', 'O', 'T'};
+  uint32_t version = OracleTableVersion;
+  uint8_t op = 0; // TraceOp
+  uint8_t bitWidth = 0;
+  uint8_t reserved[6] = {};
+  uint64_t numEntries = 0;
+};
+
+static_assert(sizeof(OracleTableHeader) == 24, "Table header layout changed");
+static_assert(sizeof(PackedKnownBits) == 2, "Table entry layout changed");
+
+class OracleTable {
+public:
+  OracleTable() = default;
+  OracleTable(unsigned bitWidth, std::vector<PackedKnownBits> entries)
+      : Lattice(bitWidth), Entries(std::move(entries)) {
+    assert(Entries.size() == Lattice.size() * Lattice.size() &&
+           "Table does not cover every pair");
+  }
+
+  bool empty() const { return Entries.empty(); }
+  unsigned getBitWidth() const { return empty() ? 0 : Lattice.getBitWidth(); }
+  uint64_t size() const { return Entries.size(); }
+
+  // Optimal result for operands given as (Zero, One) masks of this width
+  PackedKnownBits lookup(uint32_t lhsZero, uint32_t lhsOne, uint32_t rhsZero,
+                         uint32_t rhsOne) const {
+    uint64_t lhs = Lattice.rankOf(lhsZero, lhsOne);
+    uint64_t rhs = Lattice.rankOf(rhsZero, rhsOne);
+    return Entries[lhs * Lattice.size() + rhs];
+  }
+
+  KnownBits lookup(const KnownBits &lhs, const KnownBits &rhs) const {
+    PackedKnownBits packed =
+        lookup(lhs.Zero.getZExtValue(), lhs.One.getZExtValue(),
+               rhs.Zero.getZExtValue(), rhs.One.getZExtValue());
+    unsigned bw = getBitWidth();
+    KnownBits kb(bw);
+    kb.Zero = APInt(bw, packed.Zero);
+    kb.One = APInt(bw, packed.One);
+    return kb;
+  }
+
+  bool save(const std::string &path, std::string &error) const {
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+      error = path + ": " + std::strerror(errno);
+      return false;
+    }
+    OracleTableHeader header;
+    header.op = static_cast<uint8_t>(TraceOp::Mulhs);
+    header.bitWidth = getBitWidth();
+    header.numEntries = Entries.size();
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(Entries.data(), sizeof(PackedKnownBits),
+                          Entries.size(), file) == Entries.size();
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok)
+      error = path + ": short write";
+    return ok;
+  }
+
+  // Loads the table for `bitWidth` from `path`. Fails without touching
+  // this table if the file is not a complete table of that width.
+  bool load(const std::string &path, unsigned bitWidth, std::string &error) {
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+      error = path + ": " + std::strerror(errno);
+      return false;
+    }
+    LatticeIndex lattice(bitWidth);
+    OracleTableHeader header;
+    bool ok = std::fread(&header, sizeof(header), 1, file) == 1 &&
+              std::memcmp(header.magic, "KBOT", 4) == 0 &&
+              header.version == OracleTableVersion &&
+              header.op == static_cast<uint8_t>(TraceOp::Mulhs) &&
+              header.bitWidth == bitWidth &&
+              header.numEntries == lattice.size() * lattice.size();
+    std::vector<PackedKnownBits> entries;
+    if (ok) {
+      entries.resize(header.numEntries);
+      ok = std::fread(entries.data(), sizeof(PackedKnownBits), entries.size(),
+                      file) == entries.size();
+    }
+    std::fclose(file);
+    if (!ok) {
+      error = path + ": not a complete version " +
+              std::to_string(OracleTableVersion) + " mulhs table of width " +
+              std::to_string(bitWidth);
+      return false;
+    }
+    Lattice = lattice;
+    Entries = std::move(entries);
+    return true;
+  }
+
+private:
+  LatticeIndex Lattice{1};
+  std::vector<PackedKnownBits> Entries;
+};
+
+template <unsigned BW>
+inline OracleTable buildMulhsOracleTable(const SweepOptions &options) {
+  static_assert(BW <= MaxOracleTableBitWidth, "Table would not fit");
+  std::vector<FixedKnownBits<BW>> allFixed = enumerateFixedWidth<BW>();
+  const size_t n = allFixed.size();
+  std::vector<PackedKnownBits> entries(n * n);
+
+  unsigned numThreads = std::max(1u, options.numThreads);
+  SweepCounters threadCounters(options);
+  auto rowCost = [&](size_t i) {
+    return pairRowCost(__builtin_popcount(allFixed[i].unknown()));
+  };
+  parallelForByCost(
+      n, numThreads, rowCost,
+      [&](size_t i, unsigned thread) {
+        WorkerCounters &counters = threadCounters[thread];
+        for (size_t j = 0; j < n; j++) {
+          FixedKnownBits<BW> optimal =
+              fixedNaiveMulhs(allFixed[i], allFixed[j]);
+          entries[i * n + j] = {uint8_t(optimal.Zero), uint8_t(optimal.One)};
+          counters.skip();
+        }
+      },
+      options.schedule);
+  return OracleTable(BW, std::move(entries));
+}
+
+using OracleTableBuildFn = OracleTable (*)(const SweepOptions &);
+
+template <size_t... Is>
+constexpr std::array<OracleTableBuildFn, sizeof...(Is) + 1>
+makeOracleTableBuilders(std::index_sequence<Is...>) {
+  return {nullptr, &buildMulhsOracleTable<Is + 1>...};
+}
+
+// Returns the table builder for `bitWidth`, or nullptr if the table would
+// not fit.
+inline OracleTableBuildFn getOracleTableBuilder(unsigned bitWidth) {
+  static constexpr std::array<OracleTableBuildFn, MaxOracleTableBitWidth + 1>
+      Table = makeOracleTableBuilders(
+          std::make_index_sequence<MaxOracleTableBitWidth>());
+  if (bitWidth == 0 || bitWidth > MaxOracleTableBitWidth)
+    return nullptr;
+  return Table[bitWidth];
+}
+
+// Fills `tables[bw]` for every width up to `maxWidth`: loaded from
+// `tableDir` when cached there, otherwise built (and then saved there if
+// `tableDir` is set). Progress and timings go to `log`.
+inline bool loadOracleTables(unsigned maxWidth, const std::string &tableDir,
+                             unsigned numThreads,
+                             std::chrono::seconds progressInterval,
+                             std::ostream &log,
+                             std::vector<OracleTable> &tables) {
+  tables.assign(maxWidth + 1, OracleTable());
+  for (unsigned bw = 1; bw <= maxWidth; bw++) {
+    auto start = std::chrono::steady_clock::now();
+    std::string path;
+    std::string error;
+    if (!tableDir.empty()) {
+      path = tableDir + "/mulhs-w" + std::to_string(bw) + ".kbot";
+      if (tables[bw].load(path, bw, error)) {
+        std::chrono::duration<double> seconds =
+            std::chrono::steady_clock::now() - start;
+        log << "Oracle table bw=" << bw << ": " << tables[bw].size()
+            << " entries loaded from " << path << " in " << seconds.count()
+            << " s" << std::endl;
+        continue;
+      }
+    }
+
+    uint64_t totalKnownBits = numKnownBits(bw);
+    ProgressReporter progress("oracle table bw=" + std::to_string(bw),
+                              totalKnownBits * totalKnownBits, numThreads,
+                              progressInterval, log);
+    SweepOptions options;
+    options.numThreads = numThreads;
+    options.progress = &progress;
+    tables[bw] = getOracleTableBuilder(bw)(options);
+    std::chrono::duration<double> seconds =
+        std::chrono::steady_clock::now() - start;
+    log << "Oracle table bw=" << bw << ": " << tables[bw].size()
+        << " entries built in " << seconds.count() << " s" << std::endl;
+    if (!path.empty() && !tables[bw].save(path, error)) {
+      log << error << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_ORACLETABLE_H
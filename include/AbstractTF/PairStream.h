@@ -0,0 +1,108 @@
+// Streaming reader for text files of KnownBits pairs.
+//
+// Each line holds two operands in `01?` notation (see Format.h) separated
+// by spaces, tabs or a comma; blank lines and lines starting with '#' are
+// skipped. The input is read through one fixed-size buffer and every pair
+// is handed out as two StringRefs into that buffer, so no line is copied
+// and memory stays bounded however long the input is.
+
+#ifndef ABSTRACTTF_PAIRSTREAM_H
+#define ABSTRACTTF_PAIRSTREAM_H
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <llvm/ADT/StringRef.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace abstracttf {
+
+class PairReader {
+public:
+  // Longest line accepted; lines are never split across reads.
+  static constexpr size_t DefaultBufferSize = size_t(1) << 20;
+
+  explicit PairReader(int fd, size_t bufferSize = DefaultBufferSize)
+      : Fd(fd), Buffer(bufferSize) {}
+
+  // Next pair of the input. Both operands point into the reader's buffer
+  // and stay valid until the next call. Returns false at the end of the
+  // input or on an error, in which case error() is not empty.
+  bool next(llvm::StringRef &lhs, llvm::StringRef &rhs) {
+    llvm::StringRef line;
+    while (nextLine(line)) {
+      line = line.trim();
+      if (line.empty() || line.startswith("#"))
+        continue;
+      size_t split = line.find_first_of(" \t,");
+      lhs = line.substr(0, split);
+      rhs = line.substr(split).ltrim(" \t,");
+      if (split == llvm::StringRef::npos || rhs.empty() ||
+          rhs.find_first_of(" \t,") != llvm::StringRef::npos) {
+        Error = "line " + std::to_string(Line) + ": expected two operands";
+        return false;
+      }
+      return true;
+    }
+    return false;
+  }
+
+  // Line number of the last pair returned, starting at 1
+  uint64_t lineNumber() const { return Line; }
+  const std::string &error() const { return Error; }
+
+private:
+  bool nextLine(llvm::StringRef &line) {
+    for (;;) {
+      char *begin = Buffer.data() + Begin;
+      char *newline =
+          static_cast<char *>(std::memchr(begin, '\n', End - Begin));
+      if (newline || (Eof && Begin < End)) {
+        size_t length = newline ? newline - begin : End - Begin;
+        line = llvm::StringRef(begin, length);
+        Begin += newline ? length + 1 : length;
+        Line++;
+        return true;
+      }
+      if (Eof || !refill())
+        return false;
+    }
+  }
+
+  // Moves the partial line to the front and reads more input after it
+  bool refill() {
+    std::memmove(Buffer.data(), Buffer.data() + Begin, End - Begin);
+    End -= Begin;
+    Begin = 0;
+    if (End == Buffer.size()) {
+      Error = "line " + std::to_string(Line + 1) + ": longer than " +
+              std::to_string(Buffer.size()) + " bytes";
+      return false;
+    }
+    ssize_t n;
+    do
+      n = ::read(Fd, Buffer.data() + End, Buffer.size() - End);
+    while (n < 0 && errno == EINTR);
+    if (n < 0) {
+      Error = std::strerror(errno);
+      return false;
+    }
+    End += n;
+    Eof = n == 0;
+    return true;
+  }
+
+  int Fd;
+  std::vector<char> Buffer;
+  size_t Begin = 0;
+  size_t End = 0;
+  bool Eof = false;
+  uint64_t Line = 0;
+  std::string Error;
+};
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_PAIRSTREAM_H
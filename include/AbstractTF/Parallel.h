@@ -0,0 +1,136 @@
+// Minimal work distribution over std::thread.
+
+#ifndef ABSTRACTTF_PARALLEL_H
+#define ABSTRACTTF_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <numeric>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+namespace abstracttf {
+
+inline unsigned defaultThreadCount() {
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Call `fn(index, threadIdx)` for every index in [0, count) on `numThreads`
+// threads. Indexes are handed out dynamically one at a time, so the cost of
+// individual items may vary freely.
+template <typename Fn>
+inline void parallelFor(size_t count, unsigned numThreads, Fn &&fn) {
+  numThreads = std::max(1u, std::min<unsigned>(numThreads, count));
+  if (numThreads == 1) {
+    for (size_t i = 0; i < count; i++)
+      fn(i, 0u);
+    return;
+  }
+
+  std::atomic<size_t> next{0};
+  std::vector<std::thread> workers;
+  workers.reserve(numThreads);
+  for (unsigned t = 0; t < numThreads; t++) {
+    workers.emplace_back([&, t] {
+      for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < count;
+           i = next.fetch_add(1, std::memory_order_relaxed))
+        fn(i, t);
+    });
+  }
+  for (std::thread &worker : workers)
+    worker.join();
+}
+
+// How a parallelForByCost run spread its work over the threads
+struct ScheduleStats {
+  std::vector<double> busySeconds; // Time each thread spent in `fn`
+  size_t numChunks = 0;
+
+  void print(std::ostream &os) const {
+    if (busySeconds.empty())
+      return;
+    double total = 0.0, longest = 0.0;
+    os << "Per-thread busy time (" << numChunks << " chunks):" << std::endl;
+    for (size_t t = 0; t < busySeconds.size(); t++) {
+      os << "  thread " << t << ": " << busySeconds[t] << " s" << std::endl;
+      total += busySeconds[t];
+      longest = std::max(longest, busySeconds[t]);
+    }
+    double mean = total / busySeconds.size();
+    os << "Busy time imbalance (max / mean): "
+       << (mean > 0 ? longest / mean : 1.0) << std::endl;
+  }
+};
+
+// Chunks per thread targeted by parallelForByCost
+constexpr size_t CostChunksPerThread = 16;
+
+// Like parallelFor, for items whose cost varies by orders of magnitude.
+// `cost(index)` estimates the relative cost of an item. Items are sorted
+// most expensive first and cut into chunks of roughly equal estimated
+// cost, so expensive items go out alone and early while cheap ones travel
+// in batches at the end, when they can fill the gaps. If `stats` is given
+// it receives the busy time of every thread.
+template <typename CostFn, typename Fn>
+inline void parallelForByCost(size_t count, unsigned numThreads,
+                              CostFn &&cost, Fn &&fn,
+                              ScheduleStats *stats = nullptr) {
+  numThreads = std::max(1u, std::min<unsigned>(numThreads, count));
+  std::vector<double> costs(count);
+  double totalCost = 0.0;
+  for (size_t i = 0; i < count; i++)
+    totalCost += costs[i] = cost(i);
+  std::vector<size_t> order(count);
+  std::iota(order.begin(), order.end(), size_t(0));
+  std::stable_sort(order.begin(), order.end(),
+                   [&](size_t a, size_t b) { return costs[a] > costs[b]; });
+
+  // chunkEnds[c] is one past the last position of chunk c in `order`
+  double target = totalCost / (numThreads * CostChunksPerThread);
+  std::vector<size_t> chunkEnds;
+  double chunkCost = 0.0;
+  for (size_t pos = 0; pos < count; pos++) {
+    chunkCost += costs[order[pos]];
+    if (chunkCost >= target || pos + 1 == count) {
+      chunkEnds.push_back(pos + 1);
+      chunkCost = 0.0;
+    }
+  }
+
+  std::vector<double> busy(numThreads, 0.0);
+  std::atomic<size_t> next{0};
+  auto work = [&](unsigned t) {
+    for (size_t c = next.fetch_add(1, std::memory_order_relaxed);
+         c < chunkEnds.size();
+         c = next.fetch_add(1, std::memory_order_relaxed)) {
+      auto start = std::chrono::steady_clock::now();
+      for (size_t pos = c ? chunkEnds[c - 1] : 0; pos < chunkEnds[c]; pos++)
+        fn(order[pos], t);
+      busy[t] += std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+    }
+  };
+  if (numThreads == 1) {
+    work(0);
+  } else {
+    std::vector<std::thread> workers;
+    workers.reserve(numThreads);
+    for (unsigned t = 0; t < numThreads; t++)
+      workers.emplace_back(work, t);
+    for (std::thread &worker : workers)
+      worker.join();
+  }
+
+  if (stats) {
+    stats->busySeconds = std::move(busy);
+    stats->numChunks = chunkEnds.size();
+  }
+}
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_PARALLEL_H
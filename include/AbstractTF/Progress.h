@@ -0,0 +1,187 @@
+// Live progress reporting for long sweeps.
+//
+// Workers bump their own cache-line-sized block of counters with relaxed
+// stores; a reporter thread sums them every few seconds and prints pairs
+// done, throughput, elapsed time and ETA. SIGUSR1 asks the reporter for an
+// immediate dump of the partial precision counters.
+
+#ifndef ABSTRACTTF_PROGRESS_H
+#define ABSTRACTTF_PROGRESS_H
+
+#include "AbstractTF/Compare.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace abstracttf {
+
+// Set by the SIGUSR1 handler, consumed by the reporter thread.
+inline volatile std::sig_atomic_t StatusDumpRequested = 0;
+
+inline void installStatusSignalHandler() {
+#ifdef SIGUSR1
+  std::signal(SIGUSR1, [](int) { StatusDumpRequested = 1; });
+#endif
+}
+
+// Written by exactly one worker, read by the reporter. A relaxed load and
+// store is enough since only the owning thread writes.
+struct alignas(64) WorkerCounters {
+  std::atomic<uint64_t> pairs{0};
+  std::atomic<uint64_t> compositeMorePrecise{0};
+  std::atomic<uint64_t> naiveMorePrecise{0};
+  std::atomic<uint64_t> samePrecision{0};
+  std::atomic<uint64_t> incomparableResults{0};
+
+  static void bump(std::atomic<uint64_t> &counter) {
+    counter.store(counter.load(std::memory_order_relaxed) + 1,
+                  std::memory_order_relaxed);
+  }
+
+  void add(PrecisionOrder order) {
+    switch (order) {
+    case PrecisionOrder::FirstMorePrecise:
+      bump(compositeMorePrecise);
+      break;
+    case PrecisionOrder::SecondMorePrecise:
+      bump(naiveMorePrecise);
+      break;
+    case PrecisionOrder::Same:
+      bump(samePrecision);
+      break;
+    case PrecisionOrder::Incomparable:
+      bump(incomparableResults);
+      break;
+    }
+    bump(pairs);
+  }
+
+  // A pair that was visited but not compared
+  void skip() { bump(pairs); }
+};
+
+class ProgressReporter {
+public:
+  // Prints to `os` every `interval` (never if zero) until destroyed.
+  ProgressReporter(std::string label, uint64_t totalPairs, unsigned numWorkers,
+                   std::chrono::seconds interval, std::ostream &os)
+      : label(std::move(label)), totalPairs(totalPairs), workers(numWorkers),
+        interval(interval), os(os), start(std::chrono::steady_clock::now()) {
+    reporter = std::thread([this] { run(); });
+  }
+
+  ~ProgressReporter() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopped = true;
+    }
+    wakeup.notify_all();
+    reporter.join();
+  }
+
+  WorkerCounters &worker(unsigned i) { return workers[i]; }
+  unsigned numWorkers() const { return workers.size(); }
+
+  // For sweeps that only learn their size after some setup
+  void setTotalPairs(uint64_t total) {
+    totalPairs.store(total, std::memory_order_relaxed);
+  }
+
+private:
+  static constexpr std::chrono::milliseconds PollInterval{100};
+
+  PrecisionCounts snapshot(uint64_t &pairs) const {
+    PrecisionCounts counts;
+    pairs = 0;
+    for (const WorkerCounters &w : workers) {
+      pairs += w.pairs.load(std::memory_order_relaxed);
+      counts.compositeMorePrecise +=
+          w.compositeMorePrecise.load(std::memory_order_relaxed);
+      counts.naiveMorePrecise +=
+          w.naiveMorePrecise.load(std::memory_order_relaxed);
+      counts.samePrecision += w.samePrecision.load(std::memory_order_relaxed);
+      counts.incomparableResults +=
+          w.incomparableResults.load(std::memory_order_relaxed);
+    }
+    return counts;
+  }
+
+  static std::string formatDuration(double seconds) {
+    uint64_t s = static_cast<uint64_t>(seconds);
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%llu:%02llu:%02llu",
+                  static_cast<unsigned long long>(s / 3600),
+                  static_cast<unsigned long long>(s / 60 % 60),
+                  static_cast<unsigned long long>(s % 60));
+    return buffer;
+  }
+
+  void printProgress(bool withCounts) {
+    uint64_t pairs;
+    PrecisionCounts counts = snapshot(pairs);
+    uint64_t totalPairs = this->totalPairs.load(std::memory_order_relaxed);
+    double elapsed = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+    double rate = elapsed > 0 ? pairs / elapsed : 0.0;
+
+    char line[256];
+    std::snprintf(line, sizeof(line),
+                  "[%s] %llu/%llu pairs (%.1f%%), %.3g pairs/s, elapsed %s",
+                  label.c_str(), static_cast<unsigned long long>(pairs),
+                  static_cast<unsigned long long>(totalPairs),
+                  totalPairs ? 100.0 * pairs / totalPairs : 100.0, rate,
+                  formatDuration(elapsed).c_str());
+    os << line;
+    if (rate > 0 && totalPairs >= pairs)
+      os << ", ETA " << formatDuration((totalPairs - pairs) / rate);
+    os << std::endl;
+
+    if (withCounts)
+      os << "[" << label << "] partial: composite more precise "
+         << counts.compositeMorePrecise << ", naive more precise "
+         << counts.naiveMorePrecise << ", same " << counts.samePrecision
+         << ", incomparable " << counts.incomparableResults << std::endl;
+  }
+
+  void run() {
+    auto nextReport = start + interval;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!wakeup.wait_for(lock, PollInterval, [this] { return stopped; })) {
+      if (StatusDumpRequested) {
+        StatusDumpRequested = 0;
+        printProgress(/*withCounts=*/true);
+      }
+      if (interval.count() > 0 &&
+          std::chrono::steady_clock::now() >= nextReport) {
+        printProgress(/*withCounts=*/false);
+        nextReport += interval;
+      }
+    }
+  }
+
+  std::string label;
+  std::atomic<uint64_t> totalPairs;
+  std::vector<WorkerCounters> workers;
+  std::chrono::seconds interval;
+  std::ostream &os;
+  std::chrono::steady_clock::time_point start;
+
+  std::mutex mutex;
+  std::condition_variable wakeup;
+  bool stopped = false;
+  std::thread reporter;
+};
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_PROGRESS_H
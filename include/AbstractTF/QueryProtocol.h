@@ -0,0 +1,233 @@
+// Binary protocol of the mulhs query daemon (testMulhs --daemon).
+//
+// A request is a trace (see Trace.h) written to the daemon's Unix domain
+// socket: a TraceHeader whose numRecords is the batch size, then that many
+// TraceRecords. The daemon answers every request, in request order, with
+//
+//   QueryResponseHeader { "KBQR", version, numResults, latencyNs }
+//   QueryResult { status, bitWidth, composite.Zero, composite.One,
+//                 optimal.Zero, optimal.One } * numResults
+//
+// where latencyNs is the daemon's time from receiving the last record to
+// sending the response. A connection carries any number of requests. As in
+// traces, everything is in host byte order: both ends share a machine.
+// answerMulhsQuery is the daemon's per-record evaluation.
+
+#ifndef ABSTRACTTF_QUERYPROTOCOL_H
+#define ABSTRACTTF_QUERYPROTOCOL_H
+
+#include "AbstractTF/MulhsOracle.h"
+#include "AbstractTF/OracleTable.h"
+#include "AbstractTF/Trace.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <llvm/ADT/Optional.h>
+#include <llvm/Support/KnownBits.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+
+namespace abstracttf {
+
+constexpr uint32_t QueryProtocolVersion = 1;
+
+// Largest batch the daemon accepts in one request
+constexpr uint64_t MaxQueryRecords = uint64_t(1) << 20;
+
+enum class QueryStatus : uint8_t {
+  Table = 0,     // Optimal result from a preloaded table
+  Exact = 1,     // Optimal result computed by the oracle
+  Undecided = 2, // Oracle out of reach; optimal is top
+  Invalid = 3,   // Unknown op, bad width or conflicting operand bits
+};
+
+inline const char *queryStatusName(QueryStatus status) {
+  switch (status) {
+  case QueryStatus::Table:
+    return "table";
+  case QueryStatus::Exact:
+    return "exact";
+  case QueryStatus::Undecided:
+    return "undecided";
+  case QueryStatus::Invalid:
+    return "invalid";
+  }
+  return "unknown";
+}
+
+struct QueryResponseHeader {
+  char magic[4] = {'K', 'B', 'Q', 'R'};
+  uint32_t version = QueryProtocolVersion;
+  uint64_t numResults = 0;
+  uint64_t latencyNs = 0;
+};
+
+struct QueryResult {
+  uint8_t status = 0;
+  uint8_t bitWidth = 0;
+  uint8_t reserved[6] = {};
+  uint64_t compositeZero = 0;
+  uint64_t compositeOne = 0;
+  uint64_t optimalZero = 0;
+  uint64_t optimalOne = 0;
+
+  KnownBits composite() const { return unpack(compositeZero, compositeOne); }
+  KnownBits optimal() const { return unpack(optimalZero, optimalOne); }
+
+private:
+  KnownBits unpack(uint64_t zero, uint64_t one) const {
+    KnownBits kb(bitWidth);
+    kb.Zero = APInt(bitWidth, zero);
+    kb.One = APInt(bitWidth, one);
+    return kb;
+  }
+};
+
+static_assert(sizeof(QueryResponseHeader) == 24,
+              "Query response header layout changed");
+static_assert(sizeof(QueryResult) == sizeof(TraceRecord),
+              "Query result layout changed");
+
+// Composite and optimal mulhs of one record. `tables[bw]` answers width bw
+// when it is loaded; other widths go to tryExactMulhs.
+inline QueryResult answerMulhsQuery(const TraceRecord &record,
+                                    const std::vector<OracleTable> &tables) {
+  QueryResult result;
+  result.bitWidth = record.bitWidth;
+  unsigned bw = record.bitWidth;
+  if (!record.isValid()) {
+    result.status = static_cast<uint8_t>(QueryStatus::Invalid);
+    return result;
+  }
+
+  KnownBits lhs = record.lhs(), rhs = record.rhs();
+  KnownBits composite = KnownBits::mulhs(lhs, rhs);
+  result.compositeZero = composite.Zero.getZExtValue();
+  result.compositeOne = composite.One.getZExtValue();
+  if (bw < tables.size() && !tables[bw].empty()) {
+    PackedKnownBits optimal =
+        tables[bw].lookup(record.lhsZero, record.lhsOne, record.rhsZero,
+                          record.rhsOne);
+    result.status = static_cast<uint8_t>(QueryStatus::Table);
+    result.optimalZero = optimal.Zero;
+    result.optimalOne = optimal.One;
+  } else if (llvm::Optional<KnownBits> optimal = tryExactMulhs(lhs, rhs)) {
+    result.status = static_cast<uint8_t>(QueryStatus::Exact);
+    result.optimalZero = optimal->Zero.getZExtValue();
+    result.optimalOne = optimal->One.getZExtValue();
+  } else {
+    result.status = static_cast<uint8_t>(QueryStatus::Undecided);
+  }
+  return result;
+}
+
+// Reads exactly `size` bytes. Returns false on error or if the peer closed
+// the connection first.
+inline bool readFully(int fd, void *data, size_t size) {
+  char *bytes = static_cast<char *>(data);
+  while (size > 0) {
+    ssize_t n = ::read(fd, bytes, size);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return false;
+    bytes += n;
+    size -= n;
+  }
+  return true;
+}
+
+inline bool writeFully(int fd, const void *data, size_t size) {
+  const char *bytes = static_cast<const char *>(data);
+  while (size > 0) {
+    ssize_t n = ::send(fd, bytes, size, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return false;
+    bytes += n;
+    size -= n;
+  }
+  return true;
+}
+
+// Fills `addr` for `path`. Fails if the path does not fit sun_path.
+inline bool makeSocketAddress(const std::string &path, sockaddr_un &addr,
+                              std::string &error) {
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(addr.sun_path)) {
+    error = path + ": socket path too long";
+    return false;
+  }
+  std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+  return true;
+}
+
+// Client side of the protocol over one connection.
+class QueryClient {
+public:
+  ~QueryClient() { close(); }
+
+  bool connect(const std::string &path, std::string &error) {
+    sockaddr_un addr;
+    if (!makeSocketAddress(path, addr, error))
+      return false;
+    fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr *>(&addr),
+                            sizeof(addr)) != 0) {
+      error = path + ": " + std::strerror(errno);
+      close();
+      return false;
+    }
+    return true;
+  }
+
+  // Sends one batch and waits for its results
+  bool query(const std::vector<TraceRecord> &records,
+             std::vector<QueryResult> &results, uint64_t &latencyNs,
+             std::string &error) {
+    TraceHeader request;
+    request.numRecords = records.size();
+    if (!writeFully(fd, &request, sizeof(request)) ||
+        !writeFully(fd, records.data(), records.size() * sizeof(TraceRecord))) {
+      error = "failed to send request";
+      return false;
+    }
+    QueryResponseHeader response;
+    if (!readFully(fd, &response, sizeof(response))) {
+      error = "daemon closed the connection";
+      return false;
+    }
+    if (std::memcmp(response.magic, "KBQR", 4) != 0 ||
+        response.version != QueryProtocolVersion ||
+        response.numResults != records.size()) {
+      error = "malformed response";
+      return false;
+    }
+    results.resize(response.numResults);
+    if (!readFully(fd, results.data(), results.size() * sizeof(QueryResult))) {
+      error = "truncated response";
+      return false;
+    }
+    latencyNs = response.latencyNs;
+    return true;
+  }
+
+  void close() {
+    if (fd >= 0)
+      ::close(fd);
+    fd = -1;
+  }
+
+private:
+  int fd = -1;
+};
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_QUERYPROTOCOL_H
@@ -0,0 +1,299 @@
+// ConstantRange as a second abstract domain for the fixed-width kernels.
+//
+// A width-BW range is stored as (Lower, Size) with Size in [0, 2^BW]: 0 is
+// the empty set, 2^BW the full set, and anything else the possibly wrapped
+// interval [Lower, Lower + Size). Ranks enumerate all 2^BW * (2^BW - 1) + 2
+// of them without materializing the list.
+
+#ifndef ABSTRACTTF_RANGEDOMAIN_H
+#define ABSTRACTTF_RANGEDOMAIN_H
+
+#include "AbstractTF/FixedWidth.h"
+
+#include <bitset>
+#include <cstdint>
+#include <llvm/ADT/APInt.h>
+#include <llvm/ADT/Optional.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/IR/ConstantRange.h>
+#include <llvm/Support/ErrorHandling.h>
+#include <llvm/Support/KnownBits.h>
+#include <type_traits>
+
+namespace abstracttf {
+
+using llvm::APInt;
+using llvm::ConstantRange;
+using llvm::KnownBits;
+
+// Widest range domain handled exhaustively: 16^BW pairs, each concretized.
+constexpr unsigned MaxRangeBitWidth = 8;
+
+inline uint64_t numRanges(unsigned bitWidth) {
+  uint64_t values = uint64_t(1) << bitWidth;
+  return values * (values - 1) + 2;
+}
+
+template <unsigned BW> struct FixedRange {
+  static_assert(BW >= 1 && BW <= MaxRangeBitWidth,
+                "Range kernels support widths 1-8");
+
+  static constexpr uint32_t NumValues = uint32_t(1) << BW;
+  static constexpr uint32_t Mask = NumValues - 1;
+
+  uint32_t Lower = 0;
+  uint32_t Size = 0;
+
+  bool isEmpty() const { return Size == 0; }
+  bool isFull() const { return Size == NumValues; }
+  bool contains(uint32_t value) const {
+    return ((value - Lower) & Mask) < Size;
+  }
+
+  static FixedRange fromConstantRange(const ConstantRange &cr) {
+    assert(cr.getBitWidth() == BW && "Bitwidth mismatch");
+    if (cr.isEmptySet())
+      return {0, 0};
+    if (cr.isFullSet())
+      return {0, NumValues};
+    uint32_t lower = cr.getLower().getZExtValue();
+    uint32_t upper = cr.getUpper().getZExtValue();
+    return {lower, (upper - lower) & Mask};
+  }
+
+  ConstantRange toConstantRange() const {
+    if (isEmpty())
+      return ConstantRange::getEmpty(BW);
+    if (isFull())
+      return ConstantRange::getFull(BW);
+    return ConstantRange(APInt(BW, Lower), APInt(BW, (Lower + Size) & Mask));
+  }
+};
+
+// Bits implied by a range: the common high prefix of its unsigned min and
+// max, as computeKnownBitsFromRangeMetadata derives them.
+inline KnownBits rangeToKnownBits(const ConstantRange &range) {
+  unsigned bw = range.getBitWidth();
+  KnownBits known(bw);
+  if (range.isEmptySet())
+    return known;
+  APInt umin = range.getUnsignedMin();
+  APInt umax = range.getUnsignedMax();
+  unsigned commonPrefix = (umin ^ umax).countLeadingZeros();
+  APInt mask = APInt::getHighBitsSet(bw, commonPrefix);
+  known.One = umax & mask;
+  known.Zero = ~umax & mask;
+  return known;
+}
+
+// Rank 0 is the empty set, rank 1 the full set; the rest are ordered by
+// lower bound, then size.
+template <unsigned BW> inline FixedRange<BW> fixedRangeFromRank(uint64_t rank) {
+  constexpr uint32_t NumValues = FixedRange<BW>::NumValues;
+  if (rank == 0)
+    return {0, 0};
+  if (rank == 1)
+    return {0, NumValues};
+  rank -= 2;
+  return {uint32_t(rank / (NumValues - 1)),
+          uint32_t(rank % (NumValues - 1)) + 1};
+}
+
+// Call `fn(uint32_t)` for every element of `range`, in order from Lower
+template <unsigned BW, typename Fn>
+inline void forEachRangeElement(FixedRange<BW> range, Fn &&fn) {
+  for (uint32_t i = 0; i < range.Size; i++)
+    fn((range.Lower + i) & FixedRange<BW>::Mask);
+}
+
+// Smallest range containing a stream of concrete results. Values go into a
+// bitmap with a running unsigned min/max; at the end the complement of the
+// largest circular gap between present values is the optimal range. Ties
+// keep the gap found first, so a set that fits without wrapping comes out
+// as [umin, umax].
+template <unsigned BW> class FixedRangeBuilder {
+public:
+  void add(uint32_t value) {
+    if (!seen.test(value)) {
+      seen.set(value);
+      count++;
+    }
+    umin = value < umin ? value : umin;
+    umax = value > umax ? value : umax;
+  }
+
+  bool contains(uint32_t value) const { return seen.test(value); }
+  uint32_t size() const { return count; }
+
+  FixedRange<BW> result() const {
+    constexpr uint32_t NumValues = FixedRange<BW>::NumValues;
+    if (count == 0)
+      return {0, 0};
+    if (count == NumValues)
+      return {0, NumValues};
+
+    // The wrap-around gap from umax to umin first, then the inner ones
+    uint32_t bestGap = NumValues - 1 - umax + umin;
+    uint32_t bestLower = umin;
+    uint32_t previous = umin;
+    for (uint32_t v = umin + 1; v <= umax; v++) {
+      if (!seen.test(v))
+        continue;
+      uint32_t gap = v - previous - 1;
+      if (gap > bestGap) {
+        bestGap = gap;
+        bestLower = v;
+      }
+      previous = v;
+    }
+    return {bestLower, NumValues - bestGap};
+  }
+
+private:
+  std::bitset<FixedRange<BW>::NumValues> seen;
+  uint32_t count = 0;
+  uint32_t umin = FixedRange<BW>::Mask;
+  uint32_t umax = 0;
+};
+
+enum class RangeOp : uint8_t {
+  Mul,
+  SMulSat,
+  UMulSat,
+  UDiv,
+  SDiv,
+  URem,
+  SRem,
+};
+
+constexpr RangeOp AllRangeOps[] = {
+    RangeOp::Mul,  RangeOp::SMulSat, RangeOp::UMulSat, RangeOp::UDiv,
+    RangeOp::SDiv, RangeOp::URem,    RangeOp::SRem,
+};
+
+inline const char *rangeOpName(RangeOp op) {
+  switch (op) {
+  case RangeOp::Mul:
+    return "mul";
+  case RangeOp::SMulSat:
+    return "smul_sat";
+  case RangeOp::UMulSat:
+    return "umul_sat";
+  case RangeOp::UDiv:
+    return "udiv";
+  case RangeOp::SDiv:
+    return "sdiv";
+  case RangeOp::URem:
+    return "urem";
+  case RangeOp::SRem:
+    return "srem";
+  }
+  llvm_unreachable("Unknown range op");
+}
+
+inline llvm::Optional<RangeOp> parseRangeOp(llvm::StringRef name) {
+  for (RangeOp op : AllRangeOps)
+    if (name == rangeOpName(op))
+      return op;
+  return llvm::None;
+}
+
+// LLVM's transfer function for `op`
+inline ConstantRange compositeRangeOp(RangeOp op, const ConstantRange &lhs,
+                                      const ConstantRange &rhs) {
+  switch (op) {
+  case RangeOp::Mul:
+    return lhs.multiply(rhs);
+  case RangeOp::SMulSat:
+    return lhs.smul_sat(rhs);
+  case RangeOp::UMulSat:
+    return lhs.umul_sat(rhs);
+  case RangeOp::UDiv:
+    return lhs.udiv(rhs);
+  case RangeOp::SDiv:
+    return lhs.sdiv(rhs);
+  case RangeOp::URem:
+    return lhs.urem(rhs);
+  case RangeOp::SRem:
+    return lhs.srem(rhs);
+  }
+  llvm_unreachable("Unknown range op");
+}
+
+// Concrete semantics of `Op` on BW-bit values. Returns false if the result
+// is undefined (zero divisor, signed division overflow).
+template <unsigned BW, RangeOp Op>
+inline bool fixedConcreteRangeOp(uint32_t lhs, uint32_t rhs, uint32_t &out) {
+  constexpr uint32_t Mask = FixedKnownBits<BW>::Mask;
+  constexpr uint32_t SignBit = FixedKnownBits<BW>::SignBit;
+  constexpr int32_t SMax = int32_t(SignBit) - 1;
+  constexpr int32_t SMin = -int32_t(SignBit);
+  if constexpr (Op == RangeOp::Mul) {
+    out = (lhs * rhs) & Mask;
+  } else if constexpr (Op == RangeOp::SMulSat) {
+    int32_t prod = fixedSext<BW>(lhs) * fixedSext<BW>(rhs);
+    prod = prod > SMax ? SMax : prod < SMin ? SMin : prod;
+    out = uint32_t(prod) & Mask;
+  } else if constexpr (Op == RangeOp::UMulSat) {
+    uint32_t prod = lhs * rhs;
+    out = prod > Mask ? Mask : prod;
+  } else if constexpr (Op == RangeOp::UDiv) {
+    if (rhs == 0)
+      return false;
+    out = lhs / rhs;
+  } else if constexpr (Op == RangeOp::SDiv) {
+    if (rhs == 0 || (lhs == SignBit && rhs == Mask))
+      return false;
+    out = uint32_t(fixedSext<BW>(lhs) / fixedSext<BW>(rhs)) & Mask;
+  } else if constexpr (Op == RangeOp::URem) {
+    if (rhs == 0)
+      return false;
+    out = lhs % rhs;
+  } else if constexpr (Op == RangeOp::SRem) {
+    if (rhs == 0 || (lhs == SignBit && rhs == Mask))
+      return false;
+    out = uint32_t(fixedSext<BW>(lhs) % fixedSext<BW>(rhs)) & Mask;
+  } else {
+    static_assert(Op != Op, "Missing concrete semantics");
+  }
+  return true;
+}
+
+// Call `fn(std::integral_constant<RangeOp, Op>())` for the runtime `op`
+template <typename Fn> inline void withRangeOp(RangeOp op, Fn &&fn) {
+#define ABSTRACTTF_RANGE_OP_CASE(NAME)                                         \
+  case RangeOp::NAME:                                                          \
+    return fn(std::integral_constant<RangeOp, RangeOp::NAME>());
+  switch (op) {
+    ABSTRACTTF_RANGE_OP_CASE(Mul)
+    ABSTRACTTF_RANGE_OP_CASE(SMulSat)
+    ABSTRACTTF_RANGE_OP_CASE(UMulSat)
+    ABSTRACTTF_RANGE_OP_CASE(UDiv)
+    ABSTRACTTF_RANGE_OP_CASE(SDiv)
+    ABSTRACTTF_RANGE_OP_CASE(URem)
+    ABSTRACTTF_RANGE_OP_CASE(SRem)
+  }
+#undef ABSTRACTTF_RANGE_OP_CASE
+  llvm_unreachable("Unknown range op");
+}
+
+// Optimal range transfer function for `Op`. The results of every defined
+// concrete pair are streamed into `builder`, which the caller may also use
+// to check a composite result for soundness.
+template <unsigned BW, RangeOp Op>
+inline FixedRange<BW> fixedOptimalRangeOp(FixedRange<BW> lhs,
+                                          FixedRange<BW> rhs,
+                                          FixedRangeBuilder<BW> &builder) {
+  forEachRangeElement(lhs, [&](uint32_t cLhs) {
+    forEachRangeElement(rhs, [&](uint32_t cRhs) {
+      uint32_t value;
+      if (fixedConcreteRangeOp<BW, Op>(cLhs, cRhs, value))
+        builder.add(value);
+    });
+  });
+  return builder.result();
+}
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_RANGEDOMAIN_H
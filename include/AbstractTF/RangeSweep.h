@@ -0,0 +1,199 @@
+// Exhaustive sweep of ConstantRange transfer functions over every pair of
+// ranges of one width.
+//
+// The composite result is checked for soundness against the oracle's
+// concrete results and its size is compared with the optimal range.
+// Precision is broken down by the size of the optimal result, bucketed by
+// powers of two.
+
+#ifndef ABSTRACTTF_RANGESWEEP_H
+#define ABSTRACTTF_RANGESWEEP_H
+
+#include "AbstractTF/Compare.h"
+#include "AbstractTF/Parallel.h"
+#include "AbstractTF/Progress.h"
+#include "AbstractTF/RangeDomain.h"
+#include "AbstractTF/Sweep.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <llvm/IR/ConstantRange.h>
+#include <llvm/Support/MathExtras.h>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace abstracttf {
+
+using llvm::ConstantRange;
+
+// Bucket 0 holds empty results, bucket b > 0 sizes in (2^(b-2), 2^(b-1)].
+constexpr unsigned NumRangeSizeBuckets = MaxRangeBitWidth + 2;
+
+inline unsigned rangeSizeBucket(uint64_t size) {
+  return size == 0 ? 0 : llvm::Log2_64_Ceil(size) + 1;
+}
+
+struct RangeSizeBucket {
+  uint64_t pairs = 0;
+  uint64_t optimal = 0; // Pairs where the composite size is optimal
+  uint64_t compositeSize = 0;
+  uint64_t optimalSize = 0;
+
+  RangeSizeBucket &operator+=(const RangeSizeBucket &other) {
+    pairs += other.pairs;
+    optimal += other.optimal;
+    compositeSize += other.compositeSize;
+    optimalSize += other.optimalSize;
+    return *this;
+  }
+};
+
+struct RangeSweepResult {
+  SweepResult sweep;
+  std::array<RangeSizeBucket, NumRangeSizeBuckets> bySize;
+
+  RangeSweepResult &operator+=(const RangeSweepResult &other) {
+    sweep += other.sweep;
+    for (unsigned b = 0; b < NumRangeSizeBuckets; b++)
+      bySize[b] += other.bySize[b];
+    return *this;
+  }
+};
+
+using RangeSweepWorker = BasicSweepWorker<RangeSweepResult>;
+
+// Returns one RangeSweepResult per entry of `ops`, in order. Ranges are
+// decoded from their rank as the sweep goes.
+template <unsigned BW>
+inline std::vector<RangeSweepResult>
+sweepRangeOpsFixedWidth(const std::vector<RangeOp> &ops,
+                        const SweepOptions &options) {
+  const uint64_t total = numRanges(BW);
+  std::vector<RangeSweepResult> results(ops.size());
+
+  // A row costs the oracle one pass per element of the lhs range
+  auto rowCost = [](size_t i) {
+    return std::max(1.0, double(fixedRangeFromRank<BW>(i).Size));
+  };
+  runMultiSweepRows(total, rowCost, options, results,
+                    [&](size_t i, RangeSweepWorker *workers) {
+    FixedRange<BW> lhs = fixedRangeFromRank<BW>(i);
+    ConstantRange lhsRange = lhs.toConstantRange();
+    for (uint64_t j = 0; j < total; j++) {
+      FixedRange<BW> rhs = fixedRangeFromRank<BW>(j);
+      ConstantRange rhsRange = rhs.toConstantRange();
+      for (size_t k = 0; k < ops.size(); k++) {
+        RangeSweepWorker &worker = workers[k];
+        RangeSweepResult &partial = worker.partial;
+        auto t1 = std::chrono::high_resolution_clock::now();
+        ConstantRange composite =
+            compositeRangeOp(ops[k], lhsRange, rhsRange);
+        auto t2 = std::chrono::high_resolution_clock::now();
+        double timeComposite = (t2 - t1).count();
+
+        FixedRangeBuilder<BW> builder;
+        FixedRange<BW> optimal;
+        t1 = std::chrono::high_resolution_clock::now();
+        withRangeOp(ops[k], [&](auto op) {
+          optimal = fixedOptimalRangeOp<BW, decltype(op)::value>(lhs, rhs,
+                                                                 builder);
+        });
+        t2 = std::chrono::high_resolution_clock::now();
+        double timeNaive = (t2 - t1).count();
+
+        // Non-empty operands without a single defined result (a divisor
+        // range of {0}); empty operands still score their empty result
+        if (builder.size() == 0 && !lhs.isEmpty() && !rhs.isEmpty()) {
+          partial.sweep.undefinedPairs++;
+          worker.counters->skip();
+          continue;
+        }
+        partial.sweep.totalTimeComposite += timeComposite;
+        partial.sweep.totalTimeNaive += timeNaive;
+
+        // Sound iff every concrete result lies in the composite range
+        FixedRange<BW> compositeFixed =
+            FixedRange<BW>::fromConstantRange(composite);
+        bool sound = compositeFixed.Size >= builder.size();
+        for (uint32_t v = 0; sound && v < FixedRange<BW>::NumValues; v++)
+          sound = !builder.contains(v) || compositeFixed.contains(v);
+
+        PrecisionOrder order =
+            !sound ? PrecisionOrder::Incomparable
+            : compositeFixed.Size > optimal.Size
+                ? PrecisionOrder::SecondMorePrecise
+                : PrecisionOrder::Same;
+        partial.sweep.counts.add(order);
+        worker.counters->add(order);
+
+        RangeSizeBucket &bucket =
+            partial.bySize[rangeSizeBucket(optimal.Size)];
+        bucket.pairs++;
+        bucket.optimal += order == PrecisionOrder::Same;
+        bucket.compositeSize += compositeFixed.Size;
+        bucket.optimalSize += optimal.Size;
+      }
+    }
+  });
+
+  for (RangeSweepResult &result : results) {
+    result.sweep.bitWidth = BW;
+    result.sweep.totalKnownBits = total;
+  }
+  return results;
+}
+
+using RangeSweepFn = std::vector<RangeSweepResult> (*)(
+    const std::vector<RangeOp> &, const SweepOptions &);
+
+template <size_t... Is>
+constexpr std::array<RangeSweepFn, sizeof...(Is) + 1>
+makeRangeSweepTable(std::index_sequence<Is...>) {
+  return {nullptr, &sweepRangeOpsFixedWidth<Is + 1>...};
+}
+
+// Returns the range sweep for `bitWidth`, or nullptr if the width is out of
+// reach.
+inline RangeSweepFn getRangeFixedWidthSweep(unsigned bitWidth) {
+  static constexpr std::array<RangeSweepFn, MaxRangeBitWidth + 1> Table =
+      makeRangeSweepTable(std::make_index_sequence<MaxRangeBitWidth>());
+  if (bitWidth == 0 || bitWidth > MaxRangeBitWidth)
+    return nullptr;
+  return Table[bitWidth];
+}
+
+// printSweepResult followed by the precision breakdown by optimal size
+inline void printRangeSweepResult(std::ostream &os, const char *opName,
+                                  const RangeSweepResult &result) {
+  printSweepResult(os, opName, result.sweep);
+  os << "Precision by optimal result size" << std::endl;
+  os << std::setw(12) << "Size" << std::setw(12) << "Pairs" << std::setw(10)
+     << "Optimal" << std::setw(14) << "Avg optimal" << std::setw(16)
+     << "Avg composite" << std::endl;
+  for (unsigned b = 0; b < NumRangeSizeBuckets; b++) {
+    const RangeSizeBucket &bucket = result.bySize[b];
+    if (!bucket.pairs)
+      continue;
+    std::string label = b == 0 ? "empty" : "1";
+    if (b == 2)
+      label = "2";
+    else if (b > 2)
+      label = std::to_string((uint64_t(1) << (b - 2)) + 1) + "-" +
+              std::to_string(uint64_t(1) << (b - 1));
+    os << std::setw(12) << label << std::setw(12) << bucket.pairs
+       << std::setw(9) << std::fixed << std::setprecision(1)
+       << 100.0 * bucket.optimal / bucket.pairs << "%" << std::setw(14)
+       << double(bucket.optimalSize) / bucket.pairs << std::setw(16)
+       << double(bucket.compositeSize) / bucket.pairs << std::endl;
+    os.unsetf(std::ios::floatfield);
+    os << std::setprecision(6);
+  }
+  os << std::endl;
+}
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_RANGESWEEP_H
@@ -0,0 +1,301 @@
+// Reduced product of KnownBits and ConstantRange for mulhs.
+//
+// An element (bits, range) stands for the values allowed by both halves.
+// Each raw pair is normalized to the best (KnownBits, ConstantRange) of its
+// concretization, and pairs that normalize to the same element are kept
+// once. All elements with an empty concretization collapse into a single
+// bottom element.
+//
+// The composite mirrors how LLVM sees a mulhs: KnownBits::mulhs on the
+// bits, the sext/mul/ashr/trunc chain on the ranges, then each half
+// tightened with what the other implies. The oracle concretizes both
+// operands and abstracts the concrete products into both domains at once.
+
+#ifndef ABSTRACTTF_REDUCEDPRODUCT_H
+#define ABSTRACTTF_REDUCEDPRODUCT_H
+
+#include "AbstractTF/FixedWidth.h"
+#include "AbstractTF/Parallel.h"
+#include "AbstractTF/Progress.h"
+#include "AbstractTF/RangeDomain.h"
+#include "AbstractTF/Sweep.h"
+
+#include <array>
+#include <bitset>
+#include <chrono>
+#include <cstdint>
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/IR/ConstantRange.h>
+#include <llvm/Support/KnownBits.h>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace abstracttf {
+
+using llvm::ConstantRange;
+using llvm::KnownBits;
+
+template <unsigned BW> struct ReducedElement {
+  FixedKnownBits<BW> bits;
+  FixedRange<BW> range;
+
+  bool contains(uint32_t value) const {
+    return (value & bits.Zero) == 0 && (value & bits.One) == bits.One &&
+           range.contains(value);
+  }
+
+  bool isBottom() const { return range.isEmpty(); }
+
+  // 9 bits per field is enough for widths up to 8
+  uint64_t key() const {
+    return uint64_t(bits.Zero) | uint64_t(bits.One) << 9 |
+           uint64_t(range.Lower) << 18 | uint64_t(range.Size) << 27;
+  }
+};
+
+using ValueSet = std::bitset<uint32_t(1) << MaxRangeBitWidth>;
+
+// Best element for a set of BW-bit values; bottom if the set is empty
+template <unsigned BW>
+inline ReducedElement<BW> abstractValueSet(const ValueSet &values) {
+  constexpr uint32_t Mask = FixedKnownBits<BW>::Mask;
+  FixedRangeBuilder<BW> builder;
+  uint32_t knownZero = Mask, knownOne = Mask;
+  for (uint32_t v = 0; v <= Mask; v++) {
+    if (!values.test(v))
+      continue;
+    builder.add(v);
+    knownZero &= ~v;
+    knownOne &= v;
+  }
+  if (builder.size() == 0)
+    return {{0, 0}, {0, 0}};
+  return {{knownZero & Mask, knownOne}, builder.result()};
+}
+
+template <unsigned BW>
+inline uint32_t concretizationSize(const ReducedElement<BW> &element) {
+  uint32_t count = 0;
+  forEachRangeElement(element.range,
+                      [&](uint32_t v) { count += element.contains(v); });
+  return count;
+}
+
+template <unsigned BW> struct ReducedProductEnumeration {
+  // Distinct normalized elements, bottom first
+  std::vector<ReducedElement<BW>> elements;
+  // Concrete values of each element, in ascending order
+  std::vector<std::vector<uint32_t>> values;
+  uint64_t rawPairs = 0;
+};
+
+// Normalize every (KnownBits, ConstantRange) pair of width BW and keep one
+// representative per normalized element.
+template <unsigned BW>
+inline ReducedProductEnumeration<BW> enumerateReducedProduct() {
+  constexpr uint32_t Mask = FixedKnownBits<BW>::Mask;
+  ReducedProductEnumeration<BW> result;
+  llvm::DenseSet<uint64_t> seen;
+  auto addElement = [&](const ReducedElement<BW> &element) {
+    if (!seen.insert(element.key()).second)
+      return;
+    result.elements.push_back(element);
+    std::vector<uint32_t> &values = result.values.emplace_back();
+    if (element.isBottom())
+      return;
+    for (uint32_t v = 0; v <= Mask; v++)
+      if (element.contains(v))
+        values.push_back(v);
+  };
+  addElement({{0, 0}, {0, 0}});
+
+  uint64_t numBits = numKnownBits(BW), numRange = numRanges(BW);
+  result.rawPairs = numBits * numRange;
+  for (uint64_t b = 0; b < numBits; b++) {
+    FixedKnownBits<BW> bits = fixedKnownBitsFromRank<BW>(b);
+    for (uint64_t r = 0; r < numRange; r++) {
+      ReducedElement<BW> raw{bits, fixedRangeFromRank<BW>(r)};
+      ValueSet values;
+      forEachRangeElement(raw.range, [&](uint32_t v) {
+        if (raw.contains(v))
+          values.set(v);
+      });
+      addElement(abstractValueSet<BW>(values));
+    }
+  }
+  return result;
+}
+
+// LLVM's view of mulhs on the product: each half on its own, then each
+// tightened by the other. A conflict in either half means bottom.
+template <unsigned BW>
+inline ReducedElement<BW> compositeReducedMulhs(const KnownBits &lhsBits,
+                                                const ConstantRange &lhsRange,
+                                                const KnownBits &rhsBits,
+                                                const ConstantRange &rhsRange) {
+  KnownBits bits = KnownBits::mulhs(lhsBits, rhsBits);
+  ConstantRange range = lhsRange.signExtend(2 * BW)
+                            .multiply(rhsRange.signExtend(2 * BW))
+                            .ashr(ConstantRange(APInt(2 * BW, BW)))
+                            .truncate(BW);
+
+  KnownBits fromRange = rangeToKnownBits(range);
+  bits.Zero |= fromRange.Zero;
+  bits.One |= fromRange.One;
+  // fromKnownBits asserts that the bits do not conflict
+  if (bits.hasConflict() || range.isEmptySet())
+    return {{0, 0}, {0, 0}};
+  range = range.intersectWith(
+      ConstantRange::fromKnownBits(bits, /*IsSigned=*/true));
+  if (range.isEmptySet())
+    return {{0, 0}, {0, 0}};
+  return {FixedKnownBits<BW>::fromKnownBits(bits),
+          FixedRange<BW>::fromConstantRange(range)};
+}
+
+struct ReducedProductResult {
+  unsigned bitWidth = 0;
+  uint64_t rawPairs = 0;
+  uint64_t elements = 0;
+  PrecisionCounts counts;
+  // KnownBits::mulhs alone was imprecise, the reduced composite optimal
+  uint64_t recoveredByReduction = 0;
+  // KnownBits::mulhs alone was imprecise
+  uint64_t bitsImprecise = 0;
+  double totalTimeComposite = 0.0; // nanoseconds
+  double totalTimeNaive = 0.0;     // nanoseconds
+
+  uint64_t totalPairs() const { return elements * elements; }
+
+  ReducedProductResult &operator+=(const ReducedProductResult &other) {
+    counts += other.counts;
+    recoveredByReduction += other.recoveredByReduction;
+    bitsImprecise += other.bitsImprecise;
+    totalTimeComposite += other.totalTimeComposite;
+    totalTimeNaive += other.totalTimeNaive;
+    return *this;
+  }
+};
+
+using ReducedProductWorker = BasicSweepWorker<ReducedProductResult>;
+
+// Compare the composite against the optimal reduced product over every
+// pair of distinct normalized elements. Precision is the number of
+// concrete values an element allows.
+template <unsigned BW>
+inline ReducedProductResult sweepReducedMulhs(const SweepOptions &options) {
+  ReducedProductEnumeration<BW> product = enumerateReducedProduct<BW>();
+  const size_t n = product.elements.size();
+  std::vector<KnownBits> bitsOf;
+  std::vector<ConstantRange> rangeOf;
+  bitsOf.reserve(n);
+  rangeOf.reserve(n);
+  for (const ReducedElement<BW> &element : product.elements) {
+    bitsOf.push_back(element.bits.toKnownBits());
+    rangeOf.push_back(element.range.toConstantRange());
+  }
+
+  if (options.progress)
+    options.progress->setTotalPairs(uint64_t(n) * n);
+
+  ReducedProductResult result;
+  result.bitWidth = BW;
+  result.rawPairs = product.rawPairs;
+  result.elements = n;
+
+  // A row costs the oracle one pass per concrete value of the lhs
+  auto rowCost = [&](size_t i) {
+    return std::max(1.0, double(product.values[i].size()));
+  };
+  runSweepRows(n, rowCost, options, result,
+               [&](size_t i, ReducedProductWorker &worker) {
+    for (size_t j = 0; j < n; j++) {
+      auto t1 = std::chrono::high_resolution_clock::now();
+      ReducedElement<BW> composite = compositeReducedMulhs<BW>(
+          bitsOf[i], rangeOf[i], bitsOf[j], rangeOf[j]);
+      auto t2 = std::chrono::high_resolution_clock::now();
+      double timeComposite = (t2 - t1).count();
+
+      t1 = std::chrono::high_resolution_clock::now();
+      ValueSet results;
+      for (uint32_t cLhs : product.values[i])
+        for (uint32_t cRhs : product.values[j])
+          results.set(fixedConcreteMulhs<BW>(cLhs, cRhs));
+      ReducedElement<BW> optimal = abstractValueSet<BW>(results);
+      t2 = std::chrono::high_resolution_clock::now();
+      double timeNaive = (t2 - t1).count();
+
+      bool sound = true;
+      for (uint32_t v = 0; sound && v <= FixedKnownBits<BW>::Mask; v++)
+        sound = !results.test(v) || composite.contains(v);
+      uint32_t compositeSize = concretizationSize(composite);
+      uint32_t optimalSize = concretizationSize(optimal);
+
+      PrecisionOrder order = !sound ? PrecisionOrder::Incomparable
+                             : compositeSize > optimalSize
+                                 ? PrecisionOrder::SecondMorePrecise
+                                 : PrecisionOrder::Same;
+      worker.record(order, timeComposite, timeNaive);
+
+      // Would KnownBits alone have been optimal on the bits?
+      FixedKnownBits<BW> bitsAlone = FixedKnownBits<BW>::fromKnownBits(
+          KnownBits::mulhs(bitsOf[i], bitsOf[j]));
+      if (comparePrecision(bitsAlone, optimal.bits) ==
+          PrecisionOrder::SecondMorePrecise) {
+        worker.partial.bitsImprecise++;
+        worker.partial.recoveredByReduction += order == PrecisionOrder::Same;
+      }
+    }
+  });
+  return result;
+}
+
+using ReducedProductSweepFn = ReducedProductResult (*)(const SweepOptions &);
+
+template <size_t... Is>
+constexpr std::array<ReducedProductSweepFn, sizeof...(Is) + 1>
+makeReducedProductSweepTable(std::index_sequence<Is...>) {
+  return {nullptr, &sweepReducedMulhs<Is + 1>...};
+}
+
+// Returns the reduced-product mulhs sweep for `bitWidth`, or nullptr if the
+// width is out of reach.
+inline ReducedProductSweepFn getReducedProductSweep(unsigned bitWidth) {
+  static constexpr std::array<ReducedProductSweepFn, MaxRangeBitWidth + 1>
+      Table = makeReducedProductSweepTable(
+          std::make_index_sequence<MaxRangeBitWidth>());
+  if (bitWidth == 0 || bitWidth > MaxRangeBitWidth)
+    return nullptr;
+  return Table[bitWidth];
+}
+
+inline void printReducedProductResult(std::ostream &os,
+                                      const ReducedProductResult &result) {
+  os << "Testing reduced product KnownBits x ConstantRange mulhs for "
+        "BitWidth = "
+     << result.bitWidth << std::endl;
+  os << "Raw (KnownBits, ConstantRange) pairs: " << result.rawPairs
+     << std::endl;
+  os << "Distinct normalized elements: " << result.elements << std::endl;
+  os << "Composite transfer function more precise: "
+     << result.counts.compositeMorePrecise << std::endl;
+  os << "Naive transfer function more precise: "
+     << result.counts.naiveMorePrecise << std::endl;
+  os << "Same precision for both transfer functions: "
+     << result.counts.samePrecision << std::endl;
+  os << "Incomparable results: " << result.counts.incomparableResults
+     << std::endl;
+  os << "KnownBits::mulhs alone imprecise: " << result.bitsImprecise
+     << " (optimal after reduction: " << result.recoveredByReduction << ")"
+     << std::endl;
+  os << "Average composite time: "
+     << result.totalTimeComposite / result.totalPairs() << std::endl;
+  os << "Average naive time: " << result.totalTimeNaive / result.totalPairs()
+     << std::endl
+     << std::endl;
+}
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_REDUCEDPRODUCT_H
@@ -0,0 +1,64 @@
+// Bit-blasted mulhs oracle on top of the embedded SAT solver.
+//
+// The circuit for the high half of sext(lhs) * sext(rhs) is built once per
+// width: partial products with structural hashing, column compression
+// with full and half adders, and the product truncated to 2 * bw bits. The
+// known bits of a query are passed as assumptions, so one solver instance
+// (and everything it has learnt) is reused for every output bit of every
+// query of that width.
+
+#ifndef ABSTRACTTF_SATMULHS_H
+#define ABSTRACTTF_SATMULHS_H
+
+#include "AbstractTF/SatSolver.h"
+
+#include <cstdint>
+#include <llvm/Support/KnownBits.h>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace abstracttf {
+
+using llvm::KnownBits;
+
+constexpr uint64_t DefaultSatConflictLimit = 200000;
+
+class SatMulhsOracle {
+public:
+  struct Result {
+    KnownBits result;
+    bool exact = true;    // False if some query hit the conflict limit
+    unsigned queries = 0; // Solver calls made for this pair
+  };
+
+  explicit SatMulhsOracle(unsigned bitWidth,
+                          uint64_t conflictLimit = DefaultSatConflictLimit);
+
+  unsigned getBitWidth() const { return bitWidth; }
+
+  // Decide every output bit of mulhs(lhs, rhs) with at most two solver
+  // queries per bit; models found along the way settle other bits for free.
+  Result compute(const KnownBits &lhs, const KnownBits &rhs);
+
+  const SatSolver &getSolver() const { return solver; }
+
+private:
+  static constexpr unsigned NumRandomSamples = 16;
+
+  int mkAnd(int a, int b);
+  int mkXor(int a, int b);
+  int mkMaj(int a, int b, int c);
+  void encodeMultiplier();
+
+  unsigned bitWidth;
+  uint64_t conflictLimit;
+  SatSolver solver;
+  int trueLit;
+  std::vector<int> lhsVars, rhsVars, outVars;
+  std::map<std::pair<int, int>, int> andCache;
+};
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_SATMULHS_H
@@ -0,0 +1,56 @@
+// Small embedded CDCL SAT solver used by the bit-blasted oracles.
+//
+// It is a conventional MiniSat-style design: two watched literals, 1UIP
+// clause learning with local minimization, VSIDS with phase saving, Luby
+// restarts and activity-based learnt clause deletion. Solving under
+// assumptions keeps learnt clauses valid across calls, so one instance
+// can answer many related queries incrementally.
+
+#ifndef ABSTRACTTF_SATSOLVER_H
+#define ABSTRACTTF_SATSOLVER_H
+
+#include <cstdint>
+#include <llvm/ADT/ArrayRef.h>
+#include <memory>
+
+namespace abstracttf {
+
+// Literals follow the DIMACS convention: variable v >= 1 is the literal v
+// and its negation -v.
+class SatSolver {
+public:
+  enum class Result { Sat, Unsat, Unknown };
+
+  SatSolver();
+  ~SatSolver();
+  SatSolver(const SatSolver &) = delete;
+  SatSolver &operator=(const SatSolver &) = delete;
+
+  int newVar();
+  unsigned numVars() const;
+  unsigned numClauses() const;
+
+  // Add a permanent clause. Returns false once the clause set is
+  // unsatisfiable without any assumptions.
+  bool addClause(llvm::ArrayRef<int> lits);
+
+  // Solve with every literal of `assumptions` forced true. Stops with
+  // Unknown after `conflictLimit` conflicts (0 means no limit).
+  Result solve(llvm::ArrayRef<int> assumptions = {},
+               uint64_t conflictLimit = 0);
+
+  // Value of `lit` in the model of the last Sat result
+  bool modelValue(int lit) const;
+
+  uint64_t conflicts() const;
+  uint64_t decisions() const;
+  uint64_t propagations() const;
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> impl;
+};
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_SATSOLVER_H
@@ -0,0 +1,159 @@
+// How quickly the mulhs oracle reaches top, by concretization order.
+//
+// Every pair of one width is run through the full enumeration, the
+// early-exit walk in ordinary subset order and the early-exit walk with
+// corner values first. All three must agree; for the pairs whose optimal
+// result is top the sweep reports how many products each order evaluated
+// before it could stop.
+
+#ifndef ABSTRACTTF_SATURATIONSWEEP_H
+#define ABSTRACTTF_SATURATIONSWEEP_H
+
+#include "AbstractTF/FixedWidth.h"
+#include "AbstractTF/Parallel.h"
+#include "AbstractTF/Progress.h"
+#include "AbstractTF/Sweep.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace abstracttf {
+
+// One concretization order, summed over the sweep
+struct SaturationOrderStats {
+  uint64_t saturatedProducts = 0; // Products evaluated on saturating pairs
+  double totalTime = 0.0;         // nanoseconds, over all pairs
+
+  SaturationOrderStats &operator+=(const SaturationOrderStats &other) {
+    saturatedProducts += other.saturatedProducts;
+    totalTime += other.totalTime;
+    return *this;
+  }
+};
+
+struct SaturationSweepResult {
+  unsigned bitWidth = 0;
+  uint64_t totalPairs = 0;
+  uint64_t saturatedPairs = 0; // Pairs whose optimal result is top
+  uint64_t mismatches = 0;     // Early-exit results that differ from full
+  SaturationOrderStats full, ordinary, cornersFirst;
+
+  SaturationSweepResult &operator+=(const SaturationSweepResult &other) {
+    saturatedPairs += other.saturatedPairs;
+    mismatches += other.mismatches;
+    full += other.full;
+    ordinary += other.ordinary;
+    cornersFirst += other.cornersFirst;
+    return *this;
+  }
+};
+
+using SaturationSweepWorker = BasicSweepWorker<SaturationSweepResult>;
+
+template <unsigned BW>
+inline SaturationSweepResult sweepMulhsSaturation(const SweepOptions &options) {
+  std::vector<FixedKnownBits<BW>> allFixed = enumerateFixedWidth<BW>();
+  SaturationSweepResult result;
+  result.bitWidth = BW;
+  result.totalPairs = uint64_t(allFixed.size()) * allFixed.size();
+
+  auto rowCost = [&](size_t i) {
+    return pairRowCost(__builtin_popcount(allFixed[i].unknown()));
+  };
+  runSweepRows(allFixed.size(), rowCost, options, result,
+               [&](size_t i, SaturationSweepWorker &worker) {
+    SaturationSweepResult &partial = worker.partial;
+    FixedKnownBits<BW> lhs = allFixed[i];
+    for (FixedKnownBits<BW> rhs : allFixed) {
+      auto t1 = std::chrono::high_resolution_clock::now();
+      FixedKnownBits<BW> full =
+          fixedOptimalTransfer(lhs, rhs, fixedConcreteMulhs<BW>);
+      auto t2 = std::chrono::high_resolution_clock::now();
+      partial.full.totalTime += (t2 - t1).count();
+
+      uint64_t ordinaryProducts, cornerProducts;
+      t1 = std::chrono::high_resolution_clock::now();
+      FixedKnownBits<BW> ordinary =
+          fixedSaturatingMulhs<BW, false>(lhs, rhs, &ordinaryProducts);
+      t2 = std::chrono::high_resolution_clock::now();
+      partial.ordinary.totalTime += (t2 - t1).count();
+
+      t1 = std::chrono::high_resolution_clock::now();
+      FixedKnownBits<BW> corners =
+          fixedSaturatingMulhs<BW, true>(lhs, rhs, &cornerProducts);
+      t2 = std::chrono::high_resolution_clock::now();
+      partial.cornersFirst.totalTime += (t2 - t1).count();
+
+      // Same masks, not just as many known bits
+      bool agree = ordinary.Zero == full.Zero && ordinary.One == full.One &&
+                   corners.Zero == full.Zero && corners.One == full.One;
+      partial.mismatches += !agree;
+      worker.counters->skip();
+
+      if ((full.Zero | full.One) != 0)
+        continue;
+      partial.saturatedPairs++;
+      partial.full.saturatedProducts +=
+          uint64_t(1) << (__builtin_popcount(lhs.unknown()) +
+                          __builtin_popcount(rhs.unknown()));
+      partial.ordinary.saturatedProducts += ordinaryProducts;
+      partial.cornersFirst.saturatedProducts += cornerProducts;
+    }
+  });
+  return result;
+}
+
+using SaturationSweepFn = SaturationSweepResult (*)(const SweepOptions &);
+
+template <size_t... Is>
+constexpr std::array<SaturationSweepFn, sizeof...(Is) + 1>
+makeSaturationSweepTable(std::index_sequence<Is...>) {
+  return {nullptr, &sweepMulhsSaturation<Is + 1>...};
+}
+
+// Returns the saturation sweep for `bitWidth`, or nullptr if the width has
+// no fixed-width kernels.
+inline SaturationSweepFn getSaturationSweep(unsigned bitWidth) {
+  static constexpr std::array<SaturationSweepFn, MaxFixedBitWidth + 1> Table =
+      makeSaturationSweepTable(std::make_index_sequence<MaxFixedBitWidth>());
+  if (bitWidth == 0 || bitWidth > MaxFixedBitWidth)
+    return nullptr;
+  return Table[bitWidth];
+}
+
+inline void printSaturationSweepResult(std::ostream &os,
+                                       const SaturationSweepResult &result) {
+  os << "Testing mulhs oracle saturation for BitWidth = " << result.bitWidth
+     << std::endl;
+  os << "Pairs with a top result: " << result.saturatedPairs << " of "
+     << result.totalPairs << std::endl;
+  os << "Early-exit results differing from full enumeration: "
+     << result.mismatches << std::endl;
+  os << std::setw(16) << "Order" << std::setw(22) << "Products to top"
+     << std::setw(18) << "Avg time (ns)" << std::endl;
+  auto row = [&](const char *name, const SaturationOrderStats &stats) {
+    os << std::setw(16) << name << std::setw(22) << std::fixed
+       << std::setprecision(2);
+    // No pair saturates at the narrowest widths
+    if (result.saturatedPairs)
+      os << double(stats.saturatedProducts) / result.saturatedPairs;
+    else
+      os << "n/a";
+    os << std::setw(18) << stats.totalTime / result.totalPairs << std::endl;
+    os.unsetf(std::ios::floatfield);
+    os << std::setprecision(6);
+  };
+  row("full", result.full);
+  row("ordinary", result.ordinary);
+  row("corners first", result.cornersFirst);
+  os << std::endl;
+}
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_SATURATIONSWEEP_H
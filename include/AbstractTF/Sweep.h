@@ -0,0 +1,271 @@
+// Exhaustive comparison of a composite transfer function against an oracle
+// over every pair of abstract values of one bit width.
+
+#ifndef ABSTRACTTF_SWEEP_H
+#define ABSTRACTTF_SWEEP_H
+
+#include "AbstractTF/Allocations.h"
+#include "AbstractTF/Compare.h"
+#include "AbstractTF/Histogram.h"
+#include "AbstractTF/Parallel.h"
+#include "AbstractTF/Progress.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <llvm/Support/KnownBits.h>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+namespace abstracttf {
+
+using llvm::KnownBits;
+
+struct SweepResult {
+  unsigned bitWidth = 0;
+  uint64_t totalKnownBits = 0;
+  PrecisionCounts counts;
+  double totalTimeComposite = 0.0; // nanoseconds
+  double totalTimeNaive = 0.0;     // nanoseconds
+  AllocationCounts compositeAllocations;
+  AllocationCounts naiveAllocations;
+  // Pairs skipped because no concretization has a defined result
+  uint64_t undefinedPairs = 0;
+
+  // 1 for unary sweeps, which visit each abstract value once
+  unsigned arity = 2;
+
+  uint64_t totalPairs() const {
+    return arity == 1 ? totalKnownBits : totalKnownBits * totalKnownBits;
+  }
+  uint64_t comparedPairs() const { return totalPairs() - undefinedPairs; }
+
+  // Accumulate the counters and times of a partial result for the same
+  // width
+  SweepResult &operator+=(const SweepResult &other) {
+    counts += other.counts;
+    totalTimeComposite += other.totalTimeComposite;
+    totalTimeNaive += other.totalTimeNaive;
+    compositeAllocations += other.compositeAllocations;
+    naiveAllocations += other.naiveAllocations;
+    undefinedPairs += other.undefinedPairs;
+    return *this;
+  }
+};
+
+struct SweepOptions {
+  unsigned numThreads = 1;
+  // Optional; must have at least `numThreads` workers
+  ProgressReporter *progress = nullptr;
+  // Optional; receives the per-class latency histograms of the sweep
+  LatencyProfile *latency = nullptr;
+  // Optional; receives the per-thread busy time of the sweep
+  ScheduleStats *schedule = nullptr;
+};
+
+// Precision counters of each sweep thread: the progress reporter's workers
+// when there is one, otherwise counters private to the sweep
+class SweepCounters {
+public:
+  explicit SweepCounters(const SweepOptions &options)
+      : Progress(options.progress),
+        Local(options.progress ? 0 : std::max(1u, options.numThreads)) {}
+
+  WorkerCounters &operator[](unsigned thread) {
+    return Progress ? Progress->worker(thread) : Local[thread];
+  }
+
+private:
+  ProgressReporter *Progress;
+  std::vector<WorkerCounters> Local;
+};
+
+// Per-thread state handed to sweep kernels. The record functions need a
+// `Result` with SweepResult's counts and times.
+template <typename Result> struct BasicSweepWorker {
+  Result partial;
+  WorkerCounters *counters = nullptr;
+  std::unique_ptr<LatencyProfile> latency;
+
+  // Account for one query
+  void record(PrecisionOrder order, double timeComposite, double timeNaive) {
+    partial.counts.add(order);
+    partial.totalTimeComposite += timeComposite;
+    partial.totalTimeNaive += timeNaive;
+    counters->add(order);
+  }
+
+  // Account for one (lhs, rhs) pair
+  void record(const KnownBits &lhs, const KnownBits &rhs, PrecisionOrder order,
+              double timeComposite, double timeNaive) {
+    record(order, timeComposite, timeNaive);
+    if (latency)
+      latency->record(lhs, rhs, timeComposite, timeNaive);
+  }
+
+  // Account for a pair on which the operation has no defined concrete
+  // result (e.g. every divisor is zero)
+  void recordUndefined() {
+    partial.undefinedPairs++;
+    counters->skip();
+  }
+};
+
+using SweepWorker = BasicSweepWorker<SweepResult>;
+
+// Oracle cost of a row of a pair sweep, relative to the other rows. A pair
+// costs 2^(unknowns(lhs) + unknowns(rhs)) concretizations, and the row
+// shares the same right-hand side values as every other row, so only the
+// left-hand side tells rows apart.
+inline double pairRowCost(unsigned lhsUnknownBits) {
+  return std::ldexp(1.0, lhsUnknownBits);
+}
+
+// Run `rowFn(row, workers)` for every row in [0, numRows) on
+// `options.numThreads` threads, where `workers` points at one
+// BasicSweepWorker<Result> per entry of `results`. Rows are scheduled by
+// `rowCost(row)` (see parallelForByCost). Each thread has its own workers;
+// the partials are summed into `results` with Result::operator+= (and into
+// `options.latency`, which requires a single result) at the end. The
+// results' width and value count are left to the caller.
+template <typename Result, typename RowCostFn, typename RowFn>
+inline void runMultiSweepRows(size_t numRows, RowCostFn &&rowCost,
+                              const SweepOptions &options,
+                              std::vector<Result> &results, RowFn &&rowFn) {
+  assert((!options.latency || results.size() == 1) &&
+         "Latency profiles cover a single transfer function");
+  unsigned numThreads = std::max(1u, options.numThreads);
+  size_t numResults = results.size();
+  SweepCounters counters(options);
+  std::vector<BasicSweepWorker<Result>> workers(numThreads * numResults);
+  for (unsigned t = 0; t < numThreads; t++) {
+    for (size_t r = 0; r < numResults; r++) {
+      BasicSweepWorker<Result> &worker = workers[t * numResults + r];
+      worker.counters = &counters[t];
+      if (options.latency)
+        worker.latency = std::make_unique<LatencyProfile>(
+            options.latency->getBitWidth(),
+            options.latency->getSlowestCount());
+    }
+  }
+
+  parallelForByCost(
+      numRows, numThreads, rowCost,
+      [&](size_t row, unsigned thread) {
+        rowFn(row, &workers[thread * numResults]);
+      },
+      options.schedule);
+
+  for (unsigned t = 0; t < numThreads; t++) {
+    for (size_t r = 0; r < numResults; r++) {
+      const BasicSweepWorker<Result> &worker = workers[t * numResults + r];
+      results[r] += worker.partial;
+      if (options.latency)
+        *options.latency += *worker.latency;
+    }
+  }
+}
+
+// runMultiSweepRows for rows of equal cost
+template <typename Result, typename RowFn>
+inline void runMultiSweepRows(size_t numRows, const SweepOptions &options,
+                              std::vector<Result> &results, RowFn &&rowFn) {
+  runMultiSweepRows(
+      numRows, [](size_t) { return 1.0; }, options, results, rowFn);
+}
+
+// Single-result form of runMultiSweepRows: `rowFn(row, worker)`.
+template <typename Result, typename RowCostFn, typename RowFn>
+inline void runSweepRows(size_t numRows, RowCostFn &&rowCost,
+                         const SweepOptions &options, Result &result,
+                         RowFn &&rowFn) {
+  std::vector<Result> results(1);
+  runMultiSweepRows(numRows, rowCost, options, results,
+                    [&](size_t row, BasicSweepWorker<Result> *workers) {
+                      rowFn(row, workers[0]);
+                    });
+  result += results[0];
+}
+
+// Compare `composite(lhs, rhs)` against `oracle(lhs, rhs)` for every
+// (lhs, rhs) in `allKnownBits` x `allKnownBits`, timing each call.
+template <typename CompositeFn, typename OracleFn>
+inline SweepResult sweepTransferFunctions(
+    const std::vector<KnownBits> &allKnownBits, CompositeFn &&composite,
+    OracleFn &&oracle, const SweepOptions &options = SweepOptions()) {
+  SweepResult result;
+  result.totalKnownBits = allKnownBits.size();
+  if (!allKnownBits.empty())
+    result.bitWidth = allKnownBits.front().getBitWidth();
+
+  // Iterate through all pairs, one row of LHS values per work item
+  auto rowCost = [&](size_t i) {
+    const KnownBits &LHS = allKnownBits[i];
+    return pairRowCost(LHS.getBitWidth() -
+                       (LHS.Zero | LHS.One).countPopulation());
+  };
+  runSweepRows(allKnownBits.size(), rowCost, options, result,
+               [&](size_t i, SweepWorker &worker) {
+    const KnownBits &LHS = allKnownBits[i];
+    for (const KnownBits &RHS : allKnownBits) {
+      // Compute composite and naive results
+      KnownBits compositeResult, naiveResult;
+      double timeComposite, timeNaive;
+      {
+        AllocationScope scope(worker.partial.compositeAllocations);
+        auto t1 = std::chrono::high_resolution_clock::now();
+        compositeResult = composite(LHS, RHS);
+        auto t2 = std::chrono::high_resolution_clock::now();
+        timeComposite = (t2 - t1).count();
+      }
+      {
+        AllocationScope scope(worker.partial.naiveAllocations);
+        auto t1 = std::chrono::high_resolution_clock::now();
+        naiveResult = oracle(LHS, RHS);
+        auto t2 = std::chrono::high_resolution_clock::now();
+        timeNaive = (t2 - t1).count();
+      }
+
+      worker.record(LHS, RHS, comparePrecision(compositeResult, naiveResult),
+                    timeComposite, timeNaive);
+    }
+  });
+
+  return result;
+}
+
+inline void printSweepResult(std::ostream &os, const char *opName,
+                             const SweepResult &result) {
+  // Calculate average time
+  double avgTimeComposite = result.totalTimeComposite / result.comparedPairs();
+  double avgTimeNaive = result.totalTimeNaive / result.comparedPairs();
+
+  // Report results
+  os << "Testing " << opName << " Transfer Functions for BitWidth = "
+     << result.bitWidth << std::endl;
+  os << "Total abstract values: " << result.totalKnownBits << std::endl;
+  os << "Composite transfer function more precise: "
+     << result.counts.compositeMorePrecise << std::endl;
+  os << "Naive transfer function more precise: "
+     << result.counts.naiveMorePrecise << std::endl;
+  os << "Same precision for both transfer functions: "
+     << result.counts.samePrecision << std::endl;
+  os << "Incomparable results: " << result.counts.incomparableResults
+     << std::endl;
+  if (result.undefinedPairs)
+    os << "Pairs without a defined result: " << result.undefinedPairs
+       << std::endl;
+  os << "Average composite time: " << avgTimeComposite << std::endl;
+  os << "Average naive time: " << avgTimeNaive << std::endl;
+  if (AllocationCountingEnabled)
+    printAllocationsPerCall(os, result.compositeAllocations,
+                            result.naiveAllocations, result.comparedPairs());
+  os << std::endl;
+}
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_SWEEP_H
@@ -0,0 +1,192 @@
+// Binary trace of recorded KnownBits queries.
+//
+// A trace is a 16-byte header followed by fixed-size 40-byte records, all in
+// host (little-endian) byte order, so a mapped file can be indexed directly:
+//
+//   TraceHeader { "KBTR", version, numRecords }
+//   TraceRecord { op, bitWidth, lhs.Zero, lhs.One, rhs.Zero, rhs.One } * N
+//
+// Widths up to 64 bits are supported. TraceWriter is what a compiler build
+// links in to record its queries; TraceReader maps a trace read-only.
+
+#ifndef ABSTRACTTF_TRACE_H
+#define ABSTRACTTF_TRACE_H
+
+#include <cassert>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <llvm/ADT/APInt.h>
+#include <llvm/Support/KnownBits.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <memory>
+#include <string>
+
+namespace abstracttf {
+
+using llvm::APInt;
+using llvm::KnownBits;
+
+enum class TraceOp : uint8_t {
+  Mulhs = 0,
+};
+
+inline const char *traceOpName(TraceOp op) {
+  switch (op) {
+  case TraceOp::Mulhs:
+    return "mulhs";
+  }
+  return "unknown";
+}
+
+constexpr uint32_t TraceVersion = 1;
+constexpr unsigned MaxTraceBitWidth = 64;
+
+struct TraceHeader {
+  char magic[4] = {'K', 'B', 'T', 'R'};
+  uint32_t version = TraceVersion;
+  uint64_t numRecords = 0;
+};
+
+struct TraceRecord {
+  uint8_t op = 0;
+  uint8_t bitWidth = 0;
+  uint8_t reserved[6] = {};
+  uint64_t lhsZero = 0;
+  uint64_t lhsOne = 0;
+  uint64_t rhsZero = 0;
+  uint64_t rhsOne = 0;
+
+  // A known op and width, no operand bits above the width and no bit known
+  // to be both zero and one. Records read from a file or a socket must be
+  // checked before lhs() and rhs() are used.
+  bool isValid() const {
+    if (op != static_cast<uint8_t>(TraceOp::Mulhs) || bitWidth == 0 ||
+        bitWidth > MaxTraceBitWidth)
+      return false;
+    uint64_t mask = bitWidth >= 64 ? ~uint64_t(0)
+                                   : (uint64_t(1) << bitWidth) - 1;
+    return ((lhsZero | lhsOne | rhsZero | rhsOne) & ~mask) == 0 &&
+           (lhsZero & lhsOne) == 0 && (rhsZero & rhsOne) == 0;
+  }
+
+  KnownBits lhs() const { return unpack(lhsZero, lhsOne); }
+  KnownBits rhs() const { return unpack(rhsZero, rhsOne); }
+
+  static TraceRecord make(TraceOp op, const KnownBits &lhs,
+                          const KnownBits &rhs) {
+    assert(lhs.getBitWidth() == rhs.getBitWidth() &&
+           lhs.getBitWidth() <= MaxTraceBitWidth && "Unsupported query width");
+    TraceRecord record;
+    record.op = static_cast<uint8_t>(op);
+    record.bitWidth = lhs.getBitWidth();
+    record.lhsZero = lhs.Zero.getZExtValue();
+    record.lhsOne = lhs.One.getZExtValue();
+    record.rhsZero = rhs.Zero.getZExtValue();
+    record.rhsOne = rhs.One.getZExtValue();
+    return record;
+  }
+
+private:
+  KnownBits unpack(uint64_t zero, uint64_t one) const {
+    assert(isValid() && "Unpacking an invalid record");
+    KnownBits kb(bitWidth);
+    kb.Zero = APInt(bitWidth, zero);
+    kb.One = APInt(bitWidth, one);
+    return kb;
+  }
+};
+
+static_assert(sizeof(TraceHeader) == 16, "Trace header layout changed");
+static_assert(sizeof(TraceRecord) == 40, "Trace record layout changed");
+
+// Appends records to a trace file. The record count in the header is filled
+// in by close(). Not thread-safe; use one writer per thread and concatenate.
+class TraceWriter {
+public:
+  ~TraceWriter() { close(); }
+
+  bool open(const std::string &path, std::string &error) {
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+      error = path + ": " + std::strerror(errno);
+      return false;
+    }
+    TraceHeader header;
+    std::fwrite(&header, sizeof(header), 1, file);
+    return true;
+  }
+
+  void record(TraceOp op, const KnownBits &lhs, const KnownBits &rhs) {
+    TraceRecord record = TraceRecord::make(op, lhs, rhs);
+    std::fwrite(&record, sizeof(record), 1, file);
+    numRecords++;
+  }
+
+  uint64_t size() const { return numRecords; }
+
+  void close() {
+    if (!file)
+      return;
+    TraceHeader header;
+    header.numRecords = numRecords;
+    std::fseek(file, 0, SEEK_SET);
+    std::fwrite(&header, sizeof(header), 1, file);
+    std::fclose(file);
+    file = nullptr;
+  }
+
+private:
+  std::FILE *file = nullptr;
+  uint64_t numRecords = 0;
+};
+
+// Read-only view of a trace file, memory-mapped through llvm::MemoryBuffer.
+class TraceReader {
+public:
+  bool open(const std::string &path, std::string &error) {
+    auto bufferOrErr = llvm::MemoryBuffer::getFile(
+        path, /*IsText=*/false, /*RequiresNullTerminator=*/false);
+    if (!bufferOrErr) {
+      error = path + ": " + bufferOrErr.getError().message();
+      return false;
+    }
+    buffer = std::move(*bufferOrErr);
+
+    size_t bytes = buffer->getBufferSize();
+    if (bytes < sizeof(TraceHeader)) {
+      error = path + ": truncated trace header";
+      return false;
+    }
+    std::memcpy(&header, buffer->getBufferStart(), sizeof(header));
+    if (std::memcmp(header.magic, "KBTR", 4) != 0 ||
+        header.version != TraceVersion) {
+      error = path + ": not a version " + std::to_string(TraceVersion) +
+              " KnownBits trace";
+      return false;
+    }
+    if ((bytes - sizeof(TraceHeader)) / sizeof(TraceRecord) <
+        header.numRecords) {
+      error = path + ": trace has fewer records than its header claims";
+      return false;
+    }
+    records = reinterpret_cast<const TraceRecord *>(buffer->getBufferStart() +
+                                                    sizeof(TraceHeader));
+    return true;
+  }
+
+  uint64_t size() const { return header.numRecords; }
+  const TraceRecord &operator[](uint64_t i) const { return records[i]; }
+  const TraceRecord *begin() const { return records; }
+  const TraceRecord *end() const { return records + size(); }
+
+private:
+  std::unique_ptr<llvm::MemoryBuffer> buffer;
+  TraceHeader header;
+  const TraceRecord *records = nullptr;
+};
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_TRACE_H
@@ -0,0 +1,228 @@
+// Unary operators with a KnownBits transfer function in LLVM, paired with
+// their concrete semantics on the fixed-width kernels.
+//
+// The casts change the width: sext and zext widen to 2 * BW bits, trunc
+// narrows to BW / 2. Results therefore use raw 32-bit masks rather than
+// FixedKnownBits<BW>.
+
+#ifndef ABSTRACTTF_UNARYOPS_H
+#define ABSTRACTTF_UNARYOPS_H
+
+#include "AbstractTF/FixedWidth.h"
+
+#include <cstdint>
+#include <llvm/ADT/Optional.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/ErrorHandling.h>
+#include <llvm/Support/KnownBits.h>
+#include <llvm/Support/MathExtras.h>
+#include <type_traits>
+
+namespace abstracttf {
+
+using llvm::KnownBits;
+
+enum class UnaryOp : uint8_t {
+  Abs,
+  Ctpop,
+  Ctlz,
+  Cttz,
+  Bswap,
+  Bitreverse,
+  Sext,
+  Zext,
+  Trunc,
+};
+
+constexpr UnaryOp AllUnaryOps[] = {
+    UnaryOp::Abs,        UnaryOp::Ctpop, UnaryOp::Ctlz,
+    UnaryOp::Cttz,       UnaryOp::Bswap, UnaryOp::Bitreverse,
+    UnaryOp::Sext,       UnaryOp::Zext,  UnaryOp::Trunc,
+};
+
+inline const char *unaryOpName(UnaryOp op) {
+  switch (op) {
+  case UnaryOp::Abs:
+    return "abs";
+  case UnaryOp::Ctpop:
+    return "ctpop";
+  case UnaryOp::Ctlz:
+    return "ctlz";
+  case UnaryOp::Cttz:
+    return "cttz";
+  case UnaryOp::Bswap:
+    return "bswap";
+  case UnaryOp::Bitreverse:
+    return "bitreverse";
+  case UnaryOp::Sext:
+    return "sext";
+  case UnaryOp::Zext:
+    return "zext";
+  case UnaryOp::Trunc:
+    return "trunc";
+  }
+  llvm_unreachable("Unknown unary op");
+}
+
+inline llvm::Optional<UnaryOp> parseUnaryOp(llvm::StringRef name) {
+  for (UnaryOp op : AllUnaryOps)
+    if (name == unaryOpName(op))
+      return op;
+  return llvm::None;
+}
+
+// Whether `op` is valid IR at `bitWidth` (bswap needs whole 16-bit units,
+// trunc needs a narrower result type).
+inline bool unaryOpSupported(UnaryOp op, unsigned bitWidth) {
+  switch (op) {
+  case UnaryOp::Bswap:
+    return bitWidth % 16 == 0;
+  case UnaryOp::Trunc:
+    return bitWidth > 1;
+  default:
+    return true;
+  }
+}
+
+constexpr unsigned unaryOpResultWidth(UnaryOp op, unsigned bitWidth) {
+  switch (op) {
+  case UnaryOp::Sext:
+  case UnaryOp::Zext:
+    return 2 * bitWidth;
+  case UnaryOp::Trunc:
+    return bitWidth / 2;
+  default:
+    return bitWidth;
+  }
+}
+
+// LLVM's transfer function for `op`. ctpop, ctlz and cttz have no KnownBits
+// helper, so they follow the intrinsic cases of computeKnownBits in
+// ValueTracking (with is_zero_poison false).
+inline KnownBits compositeUnaryOp(UnaryOp op, const KnownBits &kb) {
+  unsigned bw = kb.getBitWidth();
+  switch (op) {
+  case UnaryOp::Abs:
+    return kb.abs();
+  case UnaryOp::Ctpop: {
+    KnownBits result(bw);
+    unsigned lowBits = llvm::Log2_32(kb.countMaxPopulation()) + 1;
+    result.Zero.setBitsFrom(lowBits);
+    return result;
+  }
+  case UnaryOp::Ctlz: {
+    KnownBits result(bw);
+    unsigned lowBits = llvm::Log2_32(kb.countMaxLeadingZeros()) + 1;
+    result.Zero.setBitsFrom(lowBits);
+    return result;
+  }
+  case UnaryOp::Cttz: {
+    KnownBits result(bw);
+    unsigned lowBits = llvm::Log2_32(kb.countMaxTrailingZeros()) + 1;
+    result.Zero.setBitsFrom(lowBits);
+    return result;
+  }
+  case UnaryOp::Bswap:
+    return KnownBits(kb).byteSwap();
+  case UnaryOp::Bitreverse:
+    return KnownBits(kb).reverseBits();
+  case UnaryOp::Sext:
+    return kb.sext(unaryOpResultWidth(op, bw));
+  case UnaryOp::Zext:
+    return kb.zext(unaryOpResultWidth(op, bw));
+  case UnaryOp::Trunc:
+    return kb.trunc(unaryOpResultWidth(op, bw));
+  }
+  llvm_unreachable("Unknown unary op");
+}
+
+// Concrete semantics of `Op` on a BW-bit value
+template <unsigned BW, UnaryOp Op>
+constexpr uint32_t fixedConcreteUnaryOp(uint32_t value) {
+  constexpr uint32_t Mask = FixedKnownBits<BW>::Mask;
+  if constexpr (Op == UnaryOp::Abs) {
+    int32_t v = fixedSext<BW>(value);
+    return uint32_t(v < 0 ? -v : v) & Mask;
+  } else if constexpr (Op == UnaryOp::Ctpop) {
+    return __builtin_popcount(value);
+  } else if constexpr (Op == UnaryOp::Ctlz) {
+    return value ? __builtin_clz(value) - (32 - BW) : BW;
+  } else if constexpr (Op == UnaryOp::Cttz) {
+    return value ? __builtin_ctz(value) : BW;
+  } else if constexpr (Op == UnaryOp::Bswap) {
+    // Only instantiated for other widths through withUnaryOp; see
+    // unaryOpSupported
+    if constexpr (BW % 16 == 0)
+      return __builtin_bswap32(value) >> (32 - BW);
+    else
+      return value;
+  } else if constexpr (Op == UnaryOp::Bitreverse) {
+    uint32_t result = 0;
+    for (unsigned bit = 0; bit < BW; bit++)
+      result |= ((value >> bit) & 1) << (BW - 1 - bit);
+    return result;
+  } else if constexpr (Op == UnaryOp::Sext) {
+    constexpr unsigned ToBW = 2 * BW;
+    constexpr uint32_t ToMask =
+        ToBW == 32 ? ~uint32_t(0) : (uint32_t(1) << ToBW) - 1;
+    return uint32_t(fixedSext<BW>(value)) & ToMask;
+  } else if constexpr (Op == UnaryOp::Zext) {
+    return value;
+  } else if constexpr (Op == UnaryOp::Trunc) {
+    return value & ((uint32_t(1) << (BW / 2)) - 1);
+  } else {
+    static_assert(Op != Op, "Missing concrete semantics");
+  }
+}
+
+// Call `fn(std::integral_constant<UnaryOp, Op>())` for the runtime `op`
+template <typename Fn> inline void withUnaryOp(UnaryOp op, Fn &&fn) {
+#define ABSTRACTTF_UNARY_OP_CASE(NAME)                                         \
+  case UnaryOp::NAME:                                                          \
+    return fn(std::integral_constant<UnaryOp, UnaryOp::NAME>());
+  switch (op) {
+    ABSTRACTTF_UNARY_OP_CASE(Abs)
+    ABSTRACTTF_UNARY_OP_CASE(Ctpop)
+    ABSTRACTTF_UNARY_OP_CASE(Ctlz)
+    ABSTRACTTF_UNARY_OP_CASE(Cttz)
+    ABSTRACTTF_UNARY_OP_CASE(Bswap)
+    ABSTRACTTF_UNARY_OP_CASE(Bitreverse)
+    ABSTRACTTF_UNARY_OP_CASE(Sext)
+    ABSTRACTTF_UNARY_OP_CASE(Zext)
+    ABSTRACTTF_UNARY_OP_CASE(Trunc)
+  }
+#undef ABSTRACTTF_UNARY_OP_CASE
+  llvm_unreachable("Unknown unary op");
+}
+
+// Result of the unary oracle, as masks over unaryOpResultWidth bits
+struct UnaryMasks {
+  uint32_t Zero = 0;
+  uint32_t One = 0;
+};
+
+// Optimal transfer function for `Op`, streaming the concretizations of `kb`
+// and stopping as soon as every result bit is unknown.
+template <unsigned BW, UnaryOp Op>
+inline UnaryMasks fixedOptimalUnaryOp(FixedKnownBits<BW> kb) {
+  constexpr unsigned ToBW = unaryOpResultWidth(Op, BW);
+  constexpr uint32_t ToMask =
+      ToBW == 32 ? ~uint32_t(0) : (uint32_t(1) << ToBW) - 1;
+  uint32_t knownZero = ToMask;
+  uint32_t knownOne = ToMask;
+  const uint32_t unknown = kb.unknown();
+  uint32_t subset = 0;
+  do {
+    uint32_t value = fixedConcreteUnaryOp<BW, Op>(kb.One | subset);
+    knownZero &= ~value;
+    knownOne &= value;
+    if ((knownZero | knownOne) == 0)
+      break;
+    subset = (subset - unknown) & unknown;
+  } while (subset != 0);
+  return {knownZero & ToMask, knownOne};
+}
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_UNARYOPS_H
@@ -0,0 +1,108 @@
+// Exhaustive sweep of unary transfer functions over the 3^BW abstract values
+// of one width.
+//
+// Values are decoded from their rank on the fly instead of being enumerated
+// up front, so even 3^16 values need no more memory than one block per
+// thread. The oracle streams concretizations and stops as soon as nothing
+// is known.
+
+#ifndef ABSTRACTTF_UNARYSWEEP_H
+#define ABSTRACTTF_UNARYSWEEP_H
+
+#include "AbstractTF/FixedWidth.h"
+#include "AbstractTF/Sweep.h"
+#include "AbstractTF/UnaryOps.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <llvm/Support/KnownBits.h>
+#include <utility>
+#include <vector>
+
+namespace abstracttf {
+
+using llvm::KnownBits;
+
+// Abstract values per work item
+constexpr uint64_t UnarySweepBlockSize = 4096;
+
+// Returns one SweepResult per entry of `ops`, in order. Every op must be
+// supported at BW (see unaryOpSupported).
+template <unsigned BW>
+inline std::vector<SweepResult>
+sweepUnaryOpsFixedWidth(const std::vector<UnaryOp> &ops,
+                        const SweepOptions &options) {
+  const uint64_t total = numKnownBits(BW);
+  std::vector<SweepResult> results(ops.size());
+  for (SweepResult &result : results) {
+    result.bitWidth = BW;
+    result.totalKnownBits = total;
+    result.arity = 1;
+  }
+
+  size_t numBlocks = (total + UnarySweepBlockSize - 1) / UnarySweepBlockSize;
+  runMultiSweepRows(numBlocks, options, results,
+                    [&](size_t block, SweepWorker *workers) {
+    uint64_t begin = block * UnarySweepBlockSize;
+    uint64_t end = std::min(begin + UnarySweepBlockSize, total);
+    for (uint64_t rank = begin; rank < end; rank++) {
+      FixedKnownBits<BW> fixed = fixedKnownBitsFromRank<BW>(rank);
+      KnownBits kb = fixed.toKnownBits();
+
+      for (size_t k = 0; k < ops.size(); k++) {
+        SweepWorker &worker = workers[k];
+        KnownBits compositeResult;
+        UnaryMasks naiveResult;
+        double timeComposite, timeNaive;
+        {
+          AllocationScope scope(worker.partial.compositeAllocations);
+          auto t1 = std::chrono::high_resolution_clock::now();
+          compositeResult = compositeUnaryOp(ops[k], kb);
+          auto t2 = std::chrono::high_resolution_clock::now();
+          timeComposite = (t2 - t1).count();
+        }
+        {
+          AllocationScope scope(worker.partial.naiveAllocations);
+          auto t1 = std::chrono::high_resolution_clock::now();
+          withUnaryOp(ops[k], [&](auto op) {
+            naiveResult = fixedOptimalUnaryOp<BW, decltype(op)::value>(fixed);
+          });
+          auto t2 = std::chrono::high_resolution_clock::now();
+          timeNaive = (t2 - t1).count();
+        }
+
+        worker.record(comparePrecisionMasks(
+                          compositeResult.Zero.getZExtValue(),
+                          compositeResult.One.getZExtValue(),
+                          naiveResult.Zero, naiveResult.One),
+                      timeComposite, timeNaive);
+      }
+    }
+  });
+
+  return results;
+}
+
+using UnarySweepFn = std::vector<SweepResult> (*)(const std::vector<UnaryOp> &,
+                                                  const SweepOptions &);
+
+template <size_t... Is>
+constexpr std::array<UnarySweepFn, sizeof...(Is) + 1>
+makeUnarySweepTable(std::index_sequence<Is...>) {
+  return {nullptr, &sweepUnaryOpsFixedWidth<Is + 1>...};
+}
+
+// Returns the fixed-width unary sweep for `bitWidth`, or nullptr if the
+// width has no specialization.
+inline UnarySweepFn getUnaryFixedWidthSweep(unsigned bitWidth) {
+  static constexpr std::array<UnarySweepFn, MaxFixedBitWidth + 1> Table =
+      makeUnarySweepTable(std::make_index_sequence<MaxFixedBitWidth>());
+  if (bitWidth == 0 || bitWidth > MaxFixedBitWidth)
+    return nullptr;
+  return Table[bitWidth];
+}
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_UNARYSWEEP_H
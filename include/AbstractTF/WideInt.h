@@ -0,0 +1,160 @@
+// Fixed-width multi-word integers for oracle kernels past 64 bits.
+//
+// WideInt<Words> holds Words 64-bit limbs, least significant first, and
+// lives entirely on the stack. It provides just what the enumerating
+// oracles need: subset-walk arithmetic, sign extension to a wider type,
+// truncating multiplication and logical shifts.
+
+#ifndef ABSTRACTTF_WIDEINT_H
+#define ABSTRACTTF_WIDEINT_H
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <llvm/ADT/APInt.h>
+#include <llvm/ADT/ArrayRef.h>
+
+namespace abstracttf {
+
+using llvm::APInt;
+
+template <unsigned Words> struct WideInt {
+  static_assert(Words >= 1, "WideInt needs at least one limb");
+  static constexpr unsigned MaxBitWidth = 64 * Words;
+
+  std::array<uint64_t, Words> limbs{};
+
+  // Bits [0, bw) set
+  static WideInt lowMask(unsigned bw) {
+    assert(bw <= MaxBitWidth && "Mask wider than the type");
+    WideInt result;
+    for (unsigned i = 0; i < Words; i++) {
+      if (bw >= 64 * (i + 1))
+        result.limbs[i] = ~uint64_t(0);
+      else if (bw > 64 * i)
+        result.limbs[i] = (uint64_t(1) << (bw - 64 * i)) - 1;
+    }
+    return result;
+  }
+
+  static WideInt fromAPInt(const APInt &value) {
+    assert(value.getBitWidth() <= MaxBitWidth && "APInt wider than the type");
+    WideInt result;
+    const uint64_t *raw = value.getRawData();
+    for (unsigned i = 0, e = value.getNumWords(); i < e; i++)
+      result.limbs[i] = raw[i];
+    return result;
+  }
+
+  APInt toAPInt(unsigned bw) const {
+    return APInt(bw, llvm::makeArrayRef(limbs.data(), Words));
+  }
+
+  bool isZero() const {
+    return std::all_of(limbs.begin(), limbs.end(),
+                       [](uint64_t limb) { return limb == 0; });
+  }
+
+  bool bit(unsigned i) const { return (limbs[i / 64] >> (i % 64)) & 1; }
+
+  WideInt operator~() const {
+    WideInt result;
+    for (unsigned i = 0; i < Words; i++)
+      result.limbs[i] = ~limbs[i];
+    return result;
+  }
+
+  WideInt &operator&=(const WideInt &other) {
+    for (unsigned i = 0; i < Words; i++)
+      limbs[i] &= other.limbs[i];
+    return *this;
+  }
+
+  WideInt &operator|=(const WideInt &other) {
+    for (unsigned i = 0; i < Words; i++)
+      limbs[i] |= other.limbs[i];
+    return *this;
+  }
+
+  // Modulo 2^MaxBitWidth
+  WideInt &operator-=(const WideInt &other) {
+    uint64_t borrow = 0;
+    for (unsigned i = 0; i < Words; i++) {
+      uint64_t a = limbs[i], b = other.limbs[i];
+      uint64_t diff = a - b - borrow;
+      borrow = (a < b) || (a - b < borrow);
+      limbs[i] = diff;
+    }
+    return *this;
+  }
+
+  friend WideInt operator&(WideInt lhs, const WideInt &rhs) {
+    return lhs &= rhs;
+  }
+  friend WideInt operator|(WideInt lhs, const WideInt &rhs) {
+    return lhs |= rhs;
+  }
+  friend WideInt operator-(WideInt lhs, const WideInt &rhs) {
+    return lhs -= rhs;
+  }
+
+  // Low MaxBitWidth bits of the product
+  friend WideInt operator*(const WideInt &lhs, const WideInt &rhs) {
+    WideInt result;
+    for (unsigned i = 0; i < Words; i++) {
+      uint64_t carry = 0;
+      for (unsigned j = 0; i + j < Words; j++) {
+        unsigned __int128 t =
+            static_cast<unsigned __int128>(lhs.limbs[i]) * rhs.limbs[j] +
+            result.limbs[i + j] + carry;
+        result.limbs[i + j] = static_cast<uint64_t>(t);
+        carry = static_cast<uint64_t>(t >> 64);
+      }
+    }
+    return result;
+  }
+
+  WideInt lshr(unsigned shift) const {
+    WideInt result;
+    unsigned limbShift = shift / 64, bitShift = shift % 64;
+    for (unsigned i = 0; i + limbShift < Words; i++) {
+      uint64_t lo = limbs[i + limbShift] >> bitShift;
+      uint64_t hi = 0;
+      if (bitShift && i + limbShift + 1 < Words)
+        hi = limbs[i + limbShift + 1] << (64 - bitShift);
+      result.limbs[i] = lo | hi;
+    }
+    return result;
+  }
+
+  // Sign-extend the low `bw` bits into a type with at least as many limbs
+  template <unsigned ToWords> WideInt<ToWords> sext(unsigned bw) const {
+    static_assert(ToWords >= Words, "sext cannot narrow");
+    assert(bw >= 1 && bw <= MaxBitWidth && "Bad source width");
+    WideInt<ToWords> result;
+    for (unsigned i = 0; i < Words; i++)
+      result.limbs[i] = limbs[i];
+    if (!bit(bw - 1))
+      return result;
+    unsigned limb = (bw - 1) / 64, offset = bw % 64;
+    if (offset)
+      result.limbs[limb] |= ~uint64_t(0) << offset;
+    for (unsigned i = limb + 1; i < ToWords; i++)
+      result.limbs[i] = ~uint64_t(0);
+    return result;
+  }
+
+  // The low `ToWords` limbs
+  template <unsigned ToWords> WideInt<ToWords> trunc() const {
+    static_assert(ToWords <= Words, "trunc cannot widen");
+    WideInt<ToWords> result;
+    for (unsigned i = 0; i < ToWords; i++)
+      result.limbs[i] = limbs[i];
+    return result;
+  }
+};
+
+} // namespace abstracttf
+
+#endif // ABSTRACTTF_WIDEINT_H
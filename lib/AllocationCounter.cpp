@@ -0,0 +1,72 @@
+// Global operator new/delete replacements backing AllocationScope. Only
+// linked into executables when ABSTRACTTF_COUNT_ALLOCATIONS is on.
+
+#include "AbstractTF/Allocations.h"
+
+#include <cstdlib>
+#include <new>
+
+using namespace abstracttf;
+
+static void *countedAlloc(std::size_t size) {
+  if (AllocationCounts *counts = CurrentAllocationCounts) {
+    counts->allocations++;
+    counts->bytes += size;
+  }
+  return std::malloc(size ? size : 1);
+}
+
+static void *countedAlignedAlloc(std::size_t size, std::align_val_t align) {
+  if (AllocationCounts *counts = CurrentAllocationCounts) {
+    counts->allocations++;
+    counts->bytes += size;
+  }
+  std::size_t alignment = static_cast<std::size_t>(align);
+  if (alignment < sizeof(void *))
+    alignment = sizeof(void *);
+  void *ptr = nullptr;
+  if (posix_memalign(&ptr, alignment, size ? size : 1) != 0)
+    return nullptr;
+  return ptr;
+}
+
+void *operator new(std::size_t size) {
+  if (void *ptr = countedAlloc(size))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) { return operator new(size); }
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+  return countedAlloc(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+  return countedAlloc(size);
+}
+
+void *operator new(std::size_t size, std::align_val_t align) {
+  if (void *ptr = countedAlignedAlloc(size, align))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size, std::align_val_t align) {
+  return operator new(size, align);
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::align_val_t) noexcept {
+  std::free(ptr);
+}
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept {
+  std::free(ptr);
+}
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept {
+  std::free(ptr);
+}
@@ -0,0 +1,86 @@
+#include "AbstractTF/IRCorpus.h"
+#include "AbstractTF/Parallel.h"
+
+#include <llvm/Analysis/ValueTracking.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/PatternMatch.h>
+#include <llvm/IRReader/IRReader.h>
+#include <llvm/Support/SourceMgr.h>
+#include <llvm/Support/raw_ostream.h>
+
+using namespace llvm;
+using namespace llvm::PatternMatch;
+
+namespace abstracttf {
+
+void findMulhsSites(const Module &module, std::vector<MulhsSite> &sites) {
+  const DataLayout &DL = module.getDataLayout();
+
+  for (const Function &F : module) {
+    for (const Instruction &I : instructions(F)) {
+      const auto *trunc = dyn_cast<TruncInst>(&I);
+      if (!trunc)
+        continue;
+
+      Value *A, *B;
+      const APInt *shift;
+      if (!match(trunc->getOperand(0),
+                 m_Shr(m_Mul(m_SExt(m_Value(A)), m_SExt(m_Value(B))),
+                       m_APInt(shift))))
+        continue;
+
+      // Both operands and the result must have the narrow type, and the
+      // multiply must be wide enough to hold the full signed product.
+      unsigned bw = trunc->getType()->getScalarSizeInBits();
+      unsigned wideBw = trunc->getOperand(0)->getType()->getScalarSizeInBits();
+      if (!trunc->getType()->isIntegerTy() || A->getType() != trunc->getType() ||
+          B->getType() != trunc->getType() || wideBw < 2 * bw ||
+          *shift != bw)
+        continue;
+
+      MulhsSite site;
+      site.moduleName = module.getModuleIdentifier();
+      site.functionName = F.getName().str();
+      site.lhs = computeKnownBits(A, DL, 0, nullptr, trunc);
+      site.rhs = computeKnownBits(B, DL, 0, nullptr, trunc);
+      sites.push_back(std::move(site));
+    }
+  }
+}
+
+CorpusScanResult scanCorpus(const std::vector<std::string> &files,
+                            unsigned numThreads) {
+  std::vector<std::vector<MulhsSite>> perFile(files.size());
+  std::vector<std::string> perFileError(files.size());
+
+  parallelFor(files.size(), numThreads, [&](size_t i, unsigned) {
+    LLVMContext context;
+    SMDiagnostic diag;
+    std::unique_ptr<Module> module = parseIRFile(files[i], diag, context);
+    if (!module) {
+      raw_string_ostream os(perFileError[i]);
+      diag.print(files[i].c_str(), os, /*ShowColors=*/false);
+      if (perFileError[i].empty())
+        perFileError[i] = files[i] + ": failed to parse";
+      return;
+    }
+    findMulhsSites(*module, perFile[i]);
+  });
+
+  CorpusScanResult result;
+  for (size_t i = 0; i < files.size(); i++) {
+    if (!perFileError[i].empty()) {
+      result.errors.push_back(std::move(perFileError[i]));
+      continue;
+    }
+    result.modulesParsed++;
+    for (MulhsSite &site : perFile[i])
+      result.sites.push_back(std::move(site));
+  }
+  return result;
+}
+
+} // namespace abstracttf
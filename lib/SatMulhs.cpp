@@ -0,0 +1,225 @@
+#include "AbstractTF/SatMulhs.h"
+
+#include <algorithm>
+#include <deque>
+#include <llvm/ADT/APInt.h>
+
+using llvm::APInt;
+
+namespace abstracttf {
+
+SatMulhsOracle::SatMulhsOracle(unsigned bitWidth, uint64_t conflictLimit)
+    : bitWidth(bitWidth), conflictLimit(conflictLimit) {
+  trueLit = solver.newVar();
+  solver.addClause({trueLit});
+  for (unsigned i = 0; i < bitWidth; i++) {
+    lhsVars.push_back(solver.newVar());
+    rhsVars.push_back(solver.newVar());
+  }
+  encodeMultiplier();
+}
+
+int SatMulhsOracle::mkAnd(int a, int b) {
+  if (a == -trueLit || b == -trueLit || a == -b)
+    return -trueLit;
+  if (a == trueLit || a == b)
+    return b;
+  if (b == trueLit)
+    return a;
+  if (a > b)
+    std::swap(a, b);
+  auto [it, inserted] = andCache.try_emplace({a, b}, 0);
+  if (!inserted)
+    return it->second;
+
+  int z = solver.newVar();
+  solver.addClause({-z, a});
+  solver.addClause({-z, b});
+  solver.addClause({z, -a, -b});
+  return it->second = z;
+}
+
+int SatMulhsOracle::mkXor(int a, int b) {
+  if (a == -trueLit)
+    return b;
+  if (b == -trueLit)
+    return a;
+  if (a == trueLit)
+    return -b;
+  if (b == trueLit)
+    return -a;
+  if (a == b)
+    return -trueLit;
+  if (a == -b)
+    return trueLit;
+
+  int z = solver.newVar();
+  solver.addClause({-z, a, b});
+  solver.addClause({-z, -a, -b});
+  solver.addClause({z, -a, b});
+  solver.addClause({z, a, -b});
+  return z;
+}
+
+int SatMulhsOracle::mkMaj(int a, int b, int c) {
+  if (a == -trueLit)
+    return mkAnd(b, c);
+  if (a == trueLit)
+    return -mkAnd(-b, -c);
+
+  int z = solver.newVar();
+  solver.addClause({-z, a, b});
+  solver.addClause({-z, a, c});
+  solver.addClause({-z, b, c});
+  solver.addClause({z, -a, -b});
+  solver.addClause({z, -a, -c});
+  solver.addClause({z, -b, -c});
+  return z;
+}
+
+void SatMulhsOracle::encodeMultiplier() {
+  unsigned wide = 2 * bitWidth;
+  auto lhsBit = [&](unsigned i) { return lhsVars[std::min(i, bitWidth - 1)]; };
+  auto rhsBit = [&](unsigned i) { return rhsVars[std::min(i, bitWidth - 1)]; };
+
+  // Partial products of the sign-extended operands, truncated to 2 * bw
+  // bits. Sign extension repeats the top literal, so structural hashing
+  // leaves at most bw * bw distinct AND gates.
+  std::vector<std::deque<int>> columns(wide);
+  for (unsigned i = 0; i < wide; i++)
+    for (unsigned j = 0; i + j < wide; j++)
+      columns[i + j].push_back(mkAnd(lhsBit(i), rhsBit(j)));
+
+  std::vector<int> product(wide, -trueLit);
+  for (unsigned k = 0; k < wide; k++) {
+    std::deque<int> &column = columns[k];
+    while (true) {
+      // x + x at weight 2^k is x at weight 2^(k+1); x + !x is 1
+      std::sort(column.begin(), column.end());
+      std::deque<int> reduced;
+      for (size_t i = 0; i < column.size(); i++) {
+        int lit = column[i];
+        if (lit == -trueLit)
+          continue;
+        if (i + 1 < column.size() && column[i + 1] == lit) {
+          if (k + 1 < wide)
+            columns[k + 1].push_back(lit);
+          i++;
+          continue;
+        }
+        auto negation =
+            std::find(column.begin() + i + 1, column.end(), -lit);
+        if (negation != column.end()) {
+          *negation = -trueLit;
+          reduced.push_back(trueLit);
+          continue;
+        }
+        reduced.push_back(lit);
+      }
+      column = std::move(reduced);
+      if (std::count(column.begin(), column.end(), trueLit) > 1)
+        continue; // Fold the new constants as well
+
+      if (column.size() <= 1)
+        break;
+      if (column.size() >= 3) {
+        int a = column[0], b = column[1], c = column[2];
+        column.erase(column.begin(), column.begin() + 3);
+        column.push_back(mkXor(mkXor(a, b), c));
+        if (k + 1 < wide)
+          columns[k + 1].push_back(mkMaj(a, b, c));
+      } else {
+        int a = column[0], b = column[1];
+        column.clear();
+        column.push_back(mkXor(a, b));
+        if (k + 1 < wide)
+          columns[k + 1].push_back(mkAnd(a, b));
+      }
+    }
+    if (!column.empty())
+      product[k] = column.front();
+  }
+
+  outVars.assign(product.begin() + bitWidth, product.end());
+}
+
+SatMulhsOracle::Result SatMulhsOracle::compute(const KnownBits &lhs,
+                                               const KnownBits &rhs) {
+  assert(lhs.getBitWidth() == bitWidth && rhs.getBitWidth() == bitWidth &&
+         "Query width does not match the encoded circuit");
+
+  std::vector<int> assumptions;
+  for (unsigned i = 0; i < bitWidth; i++) {
+    if (lhs.Zero[i])
+      assumptions.push_back(-lhsVars[i]);
+    else if (lhs.One[i])
+      assumptions.push_back(lhsVars[i]);
+    if (rhs.Zero[i])
+      assumptions.push_back(-rhsVars[i]);
+    else if (rhs.One[i])
+      assumptions.push_back(rhsVars[i]);
+  }
+
+  Result result;
+  APInt seenZero(bitWidth, 0), seenOne(bitWidth, 0);
+  auto recordModel = [&] {
+    for (unsigned j = 0; j < bitWidth; j++) {
+      if (solver.modelValue(outVars[j]))
+        seenOne.setBit(j);
+      else
+        seenZero.setBit(j);
+    }
+  };
+
+  // Concrete samples settle most reachable values without a solver call:
+  // the signed extremes of both operands and a few pseudo-random points.
+  auto recordConcrete = [&](const APInt &l, const APInt &r) {
+    APInt high = (l.sext(2 * bitWidth) * r.sext(2 * bitWidth))
+                     .extractBits(bitWidth, bitWidth);
+    seenOne |= high;
+    seenZero |= ~high;
+  };
+  for (const APInt &l : {lhs.getSignedMinValue(), lhs.getSignedMaxValue()})
+    for (const APInt &r : {rhs.getSignedMinValue(), rhs.getSignedMaxValue()})
+      recordConcrete(l, r);
+  uint64_t state = 0x9E3779B97F4A7C15ull;
+  auto randomValue = [&](const KnownBits &kb) {
+    APInt value(bitWidth, 0);
+    for (unsigned i = 0; i < bitWidth; i += 64) {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      value.insertBits(APInt(64, state).trunc(std::min(64u, bitWidth - i)),
+                       i);
+    }
+    return (value & ~kb.Zero) | kb.One;
+  };
+  for (unsigned sample = 0; sample < NumRandomSamples; sample++)
+    recordConcrete(randomValue(lhs), randomValue(rhs));
+
+  for (unsigned i = 0; i < bitWidth; i++) {
+    for (bool value : {false, true}) {
+      if ((value ? seenOne : seenZero)[i])
+        continue;
+      assumptions.push_back(value ? outVars[i] : -outVars[i]);
+      SatSolver::Result answer = solver.solve(assumptions, conflictLimit);
+      assumptions.pop_back();
+      result.queries++;
+
+      if (answer == SatSolver::Result::Sat) {
+        recordModel();
+      } else if (answer == SatSolver::Result::Unknown) {
+        // Undecided: treat the value as reachable to stay sound
+        result.exact = false;
+        (value ? seenOne : seenZero).setBit(i);
+      }
+    }
+  }
+
+  result.result = KnownBits(bitWidth);
+  result.result.Zero = seenZero & ~seenOne;
+  result.result.One = seenOne & ~seenZero;
+  return result;
+}
+
+} // namespace abstracttf
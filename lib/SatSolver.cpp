@@ -0,0 +1,550 @@
+#include "AbstractTF/SatSolver.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <vector>
+
+namespace abstracttf {
+
+namespace {
+
+// Internal literal encoding: 2 * var + sign, with variables from 0
+using Lit = uint32_t;
+constexpr Lit UndefLit = ~Lit(0);
+
+inline Lit toLit(int dimacs) {
+  return dimacs > 0 ? Lit(2 * (dimacs - 1)) : Lit(2 * (-dimacs - 1) + 1);
+}
+inline uint32_t var(Lit lit) { return lit >> 1; }
+inline bool sign(Lit lit) { return lit & 1; }
+
+enum : int8_t { False = -1, Undef = 0, True = 1 };
+
+struct Clause {
+  std::vector<Lit> lits;
+  bool learnt = false;
+  bool deleted = false;
+  double activity = 0.0;
+};
+
+struct Watcher {
+  Clause *clause;
+  Lit blocker;
+};
+
+// Max-heap of variables ordered by activity
+class VarOrder {
+public:
+  explicit VarOrder(const std::vector<double> &activity)
+      : activity(activity) {}
+
+  bool contains(uint32_t v) const {
+    return v < indices.size() && indices[v] >= 0;
+  }
+  bool empty() const { return heap.empty(); }
+
+  void insert(uint32_t v) {
+    if (indices.size() <= v)
+      indices.resize(v + 1, -1);
+    if (contains(v))
+      return;
+    indices[v] = heap.size();
+    heap.push_back(v);
+    up(indices[v]);
+  }
+
+  void increased(uint32_t v) {
+    if (contains(v))
+      up(indices[v]);
+  }
+
+  uint32_t pop() {
+    uint32_t top = heap[0];
+    heap[0] = heap.back();
+    indices[heap[0]] = 0;
+    indices[top] = -1;
+    heap.pop_back();
+    if (!heap.empty())
+      down(0);
+    return top;
+  }
+
+private:
+  bool less(uint32_t a, uint32_t b) const {
+    return activity[a] > activity[b];
+  }
+
+  void up(int i) {
+    uint32_t v = heap[i];
+    while (i > 0) {
+      int parent = (i - 1) / 2;
+      if (!less(v, heap[parent]))
+        break;
+      heap[i] = heap[parent];
+      indices[heap[i]] = i;
+      i = parent;
+    }
+    heap[i] = v;
+    indices[v] = i;
+  }
+
+  void down(int i) {
+    uint32_t v = heap[i];
+    int size = heap.size();
+    while (2 * i + 1 < size) {
+      int child = 2 * i + 1;
+      if (child + 1 < size && less(heap[child + 1], heap[child]))
+        child++;
+      if (!less(heap[child], v))
+        break;
+      heap[i] = heap[child];
+      indices[heap[i]] = i;
+      i = child;
+    }
+    heap[i] = v;
+    indices[v] = i;
+  }
+
+  const std::vector<double> &activity;
+  std::vector<uint32_t> heap;
+  std::vector<int> indices;
+};
+
+// Luby sequence value for restart `i` (0-based)
+double luby(uint64_t i) {
+  uint64_t size = 1, seq = 0;
+  while (size < i + 1) {
+    seq++;
+    size = 2 * size + 1;
+  }
+  while (size - 1 != i) {
+    size = (size - 1) / 2;
+    seq--;
+    i = i % size;
+  }
+  return double(uint64_t(1) << seq);
+}
+
+} // namespace
+
+struct SatSolver::Impl {
+  static constexpr double VarDecay = 0.95;
+  static constexpr double ClauseDecay = 0.999;
+  static constexpr uint64_t RestartBase = 100;
+
+  bool ok = true;
+  std::vector<Clause *> clauses;
+  std::vector<Clause *> learnts;
+  std::vector<std::vector<Watcher>> watches; // Indexed by the watched literal
+
+  std::vector<int8_t> assigns;
+  std::vector<int8_t> polarity; // Saved phase: 1 means last assigned false
+  std::vector<int> levels;
+  std::vector<Clause *> reasons;
+  std::vector<Lit> trail;
+  std::vector<size_t> trailLimits;
+  size_t qhead = 0;
+
+  std::vector<double> activity;
+  double varInc = 1.0;
+  double clauseInc = 1.0;
+  VarOrder order{activity};
+
+  std::vector<int8_t> model;
+  std::vector<char> seen;
+  std::vector<Lit> analyzeToClear;
+  double maxLearnts = 0.0;
+  uint64_t restarts = 0;
+
+  uint64_t numConflicts = 0;
+  uint64_t numDecisions = 0;
+  uint64_t numPropagations = 0;
+
+  ~Impl() {
+    for (Clause *c : clauses)
+      delete c;
+    for (Clause *c : learnts)
+      delete c;
+  }
+
+  int8_t value(Lit lit) const {
+    int8_t v = assigns[var(lit)];
+    return sign(lit) ? -v : v;
+  }
+  int decisionLevel() const { return trailLimits.size(); }
+
+  void enqueue(Lit lit, Clause *reason) {
+    assert(value(lit) == Undef && "Literal already assigned");
+    uint32_t v = var(lit);
+    assigns[v] = sign(lit) ? False : True;
+    levels[v] = decisionLevel();
+    reasons[v] = reason;
+    trail.push_back(lit);
+  }
+
+  void attach(Clause *c) {
+    watches[c->lits[0]].push_back({c, c->lits[1]});
+    watches[c->lits[1]].push_back({c, c->lits[0]});
+  }
+
+  void cancelUntil(int level) {
+    if (decisionLevel() <= level)
+      return;
+    for (size_t i = trail.size(); i > trailLimits[level]; i--) {
+      uint32_t v = var(trail[i - 1]);
+      polarity[v] = sign(trail[i - 1]);
+      assigns[v] = Undef;
+      reasons[v] = nullptr;
+      order.insert(v);
+    }
+    trail.resize(trailLimits[level]);
+    trailLimits.resize(level);
+    qhead = trail.size();
+  }
+
+  Clause *propagate() {
+    while (qhead < trail.size()) {
+      Lit falseLit = trail[qhead++] ^ 1;
+      std::vector<Watcher> &ws = watches[falseLit];
+      numPropagations++;
+
+      size_t i = 0, j = 0;
+      while (i < ws.size()) {
+        Watcher w = ws[i++];
+        if (value(w.blocker) == True) {
+          ws[j++] = w;
+          continue;
+        }
+
+        Clause &c = *w.clause;
+        if (c.lits[0] == falseLit)
+          std::swap(c.lits[0], c.lits[1]);
+        Lit first = c.lits[0];
+        if (first != w.blocker && value(first) == True) {
+          ws[j++] = {w.clause, first};
+          continue;
+        }
+
+        // Look for a new literal to watch
+        bool found = false;
+        for (size_t k = 2; k < c.lits.size(); k++) {
+          if (value(c.lits[k]) != False) {
+            std::swap(c.lits[1], c.lits[k]);
+            watches[c.lits[1]].push_back({w.clause, first});
+            found = true;
+            break;
+          }
+        }
+        if (found)
+          continue;
+
+        // Unit or conflicting
+        ws[j++] = {w.clause, first};
+        if (value(first) == False) {
+          while (i < ws.size())
+            ws[j++] = ws[i++];
+          ws.resize(j);
+          qhead = trail.size();
+          return w.clause;
+        }
+        enqueue(first, w.clause);
+      }
+      ws.resize(j);
+    }
+    return nullptr;
+  }
+
+  void bumpVar(uint32_t v) {
+    if ((activity[v] += varInc) > 1e100) {
+      for (double &a : activity)
+        a *= 1e-100;
+      varInc *= 1e-100;
+    }
+    order.increased(v);
+  }
+
+  void bumpClause(Clause &c) {
+    if ((c.activity += clauseInc) > 1e20) {
+      for (Clause *learnt : learnts)
+        learnt->activity *= 1e-20;
+      clauseInc *= 1e-20;
+    }
+  }
+
+  // A literal is redundant if its reason only involves literals already in
+  // the learnt clause (or fixed at level 0).
+  bool redundant(Lit lit) const {
+    Clause *reason = reasons[var(lit)];
+    if (!reason)
+      return false;
+    for (size_t k = 1; k < reason->lits.size(); k++) {
+      uint32_t v = var(reason->lits[k]);
+      if (!seen[v] && levels[v] > 0)
+        return false;
+    }
+    return true;
+  }
+
+  void analyze(Clause *confl, std::vector<Lit> &learnt, int &backtrackLevel) {
+    int pathCount = 0;
+    Lit p = UndefLit;
+    learnt.clear();
+    learnt.push_back(UndefLit);
+    size_t index = trail.size();
+
+    do {
+      if (confl->learnt)
+        bumpClause(*confl);
+      for (size_t k = p == UndefLit ? 0 : 1; k < confl->lits.size(); k++) {
+        Lit q = confl->lits[k];
+        uint32_t v = var(q);
+        if (seen[v] || levels[v] == 0)
+          continue;
+        seen[v] = 1;
+        bumpVar(v);
+        if (levels[v] >= decisionLevel())
+          pathCount++;
+        else
+          learnt.push_back(q);
+      }
+
+      // Next literal on the trail that takes part in the conflict
+      while (!seen[var(trail[--index])])
+        ;
+      p = trail[index];
+      confl = reasons[var(p)];
+      seen[var(p)] = 0;
+      pathCount--;
+    } while (pathCount > 0);
+    learnt[0] = p ^ 1;
+
+    // Local minimization. The seen flags must stay set until every literal
+    // has been checked, so they are cleared from a copy.
+    analyzeToClear.assign(learnt.begin() + 1, learnt.end());
+    size_t kept = 1;
+    for (size_t k = 1; k < learnt.size(); k++)
+      if (!redundant(learnt[k]))
+        learnt[kept++] = learnt[k];
+    learnt.resize(kept);
+    for (Lit lit : analyzeToClear)
+      seen[var(lit)] = 0;
+
+    // Second watch goes on the literal with the highest level
+    backtrackLevel = 0;
+    if (learnt.size() > 1) {
+      size_t maxIdx = 1;
+      for (size_t k = 2; k < learnt.size(); k++)
+        if (levels[var(learnt[k])] > levels[var(learnt[maxIdx])])
+          maxIdx = k;
+      std::swap(learnt[1], learnt[maxIdx]);
+      backtrackLevel = levels[var(learnt[1])];
+    }
+  }
+
+  bool locked(const Clause *c) const {
+    return reasons[var(c->lits[0])] == c && value(c->lits[0]) == True;
+  }
+
+  void reduceLearnts() {
+    std::sort(learnts.begin(), learnts.end(),
+              [](const Clause *a, const Clause *b) {
+                return a->activity < b->activity;
+              });
+    size_t half = learnts.size() / 2;
+    for (size_t k = 0; k < half; k++)
+      if (learnts[k]->lits.size() > 2 && !locked(learnts[k]))
+        learnts[k]->deleted = true;
+
+    for (std::vector<Watcher> &ws : watches)
+      ws.erase(std::remove_if(ws.begin(), ws.end(),
+                              [](const Watcher &w) {
+                                return w.clause->deleted;
+                              }),
+               ws.end());
+    size_t kept = 0;
+    for (Clause *c : learnts) {
+      if (c->deleted)
+        delete c;
+      else
+        learnts[kept++] = c;
+    }
+    learnts.resize(kept);
+  }
+
+  Lit pickBranchLit() {
+    while (!order.empty()) {
+      uint32_t v = order.pop();
+      if (assigns[v] == Undef)
+        return Lit(2 * v + polarity[v]);
+    }
+    return UndefLit;
+  }
+
+  // Unknown once `conflictBudget` conflicts have passed (a restart) or, if
+  // `limited`, once `conflictsLeft` reaches 0.
+  Result search(llvm::ArrayRef<int> assumptions, uint64_t conflictBudget,
+                bool limited, uint64_t &conflictsLeft) {
+    std::vector<Lit> learnt;
+    uint64_t conflictsHere = 0;
+
+    while (true) {
+      if (Clause *confl = propagate()) {
+        numConflicts++;
+        conflictsHere++;
+        if (decisionLevel() == 0) {
+          ok = false;
+          return Result::Unsat;
+        }
+        if (limited && --conflictsLeft == 0) {
+          cancelUntil(0);
+          return Result::Unknown;
+        }
+
+        int backtrackLevel;
+        analyze(confl, learnt, backtrackLevel);
+        cancelUntil(backtrackLevel);
+        if (learnt.size() == 1) {
+          enqueue(learnt[0], nullptr);
+        } else {
+          Clause *c = new Clause;
+          c->lits = learnt;
+          c->learnt = true;
+          learnts.push_back(c);
+          attach(c);
+          bumpClause(*c);
+          enqueue(learnt[0], c);
+        }
+        varInc /= VarDecay;
+        clauseInc /= ClauseDecay;
+        continue;
+      }
+
+      if (conflictsHere >= conflictBudget) {
+        cancelUntil(0);
+        return Result::Unknown; // Restart
+      }
+      if (learnts.size() >= maxLearnts + trail.size()) {
+        reduceLearnts();
+        maxLearnts *= 1.1;
+      }
+
+      Lit next = UndefLit;
+      while (decisionLevel() < static_cast<int>(assumptions.size())) {
+        Lit a = toLit(assumptions[decisionLevel()]);
+        if (value(a) == True) {
+          trailLimits.push_back(trail.size()); // Dummy level
+        } else if (value(a) == False) {
+          return Result::Unsat; // Under these assumptions
+        } else {
+          next = a;
+          break;
+        }
+      }
+
+      if (next == UndefLit) {
+        next = pickBranchLit();
+        if (next == UndefLit) {
+          model = assigns;
+          return Result::Sat;
+        }
+        numDecisions++;
+      }
+      trailLimits.push_back(trail.size());
+      enqueue(next, nullptr);
+    }
+  }
+};
+
+SatSolver::SatSolver() : impl(std::make_unique<Impl>()) {}
+SatSolver::~SatSolver() = default;
+
+int SatSolver::newVar() {
+  uint32_t v = impl->assigns.size();
+  impl->assigns.push_back(Undef);
+  impl->polarity.push_back(1);
+  impl->levels.push_back(0);
+  impl->reasons.push_back(nullptr);
+  impl->activity.push_back(0.0);
+  impl->seen.push_back(0);
+  impl->watches.emplace_back();
+  impl->watches.emplace_back();
+  impl->order.insert(v);
+  return v + 1;
+}
+
+unsigned SatSolver::numVars() const { return impl->assigns.size(); }
+unsigned SatSolver::numClauses() const { return impl->clauses.size(); }
+
+bool SatSolver::addClause(llvm::ArrayRef<int> dimacs) {
+  Impl &s = *impl;
+  assert(s.decisionLevel() == 0 && "Clauses are added between solves");
+  if (!s.ok)
+    return false;
+
+  std::vector<Lit> lits;
+  for (int d : dimacs) {
+    assert(d != 0 && static_cast<unsigned>(std::abs(d)) <= numVars() &&
+           "Literal of an unknown variable");
+    lits.push_back(toLit(d));
+  }
+  std::sort(lits.begin(), lits.end());
+
+  // Drop duplicates and false literals; skip satisfied or tautological
+  // clauses
+  size_t kept = 0;
+  Lit prev = UndefLit;
+  for (Lit lit : lits) {
+    if (s.value(lit) == True || lit == (prev ^ 1))
+      return true;
+    if (s.value(lit) != False && lit != prev)
+      lits[kept++] = prev = lit;
+  }
+  lits.resize(kept);
+
+  if (lits.empty())
+    return s.ok = false;
+  if (lits.size() == 1) {
+    s.enqueue(lits[0], nullptr);
+    return s.ok = s.propagate() == nullptr;
+  }
+
+  Clause *c = new Clause;
+  c->lits = std::move(lits);
+  s.clauses.push_back(c);
+  s.attach(c);
+  return true;
+}
+
+SatSolver::Result SatSolver::solve(llvm::ArrayRef<int> assumptions,
+                                   uint64_t conflictLimit) {
+  Impl &s = *impl;
+  if (!s.ok)
+    return Result::Unsat;
+  if (s.propagate()) {
+    s.ok = false;
+    return Result::Unsat;
+  }
+
+  s.maxLearnts = std::max<double>(s.maxLearnts, s.clauses.size() / 3.0);
+  bool limited = conflictLimit != 0;
+  uint64_t conflictsLeft = conflictLimit;
+  Result result = Result::Unknown;
+  while (result == Result::Unknown && (!limited || conflictsLeft > 0)) {
+    uint64_t budget = Impl::RestartBase * luby(s.restarts++);
+    result = s.search(assumptions, budget, limited, conflictsLeft);
+  }
+  s.cancelUntil(0);
+  return result;
+}
+
+bool SatSolver::modelValue(int lit) const {
+  int8_t v = impl->model[std::abs(lit) - 1];
+  return lit > 0 ? v == True : v == False;
+}
+
+uint64_t SatSolver::conflicts() const { return impl->numConflicts; }
+uint64_t SatSolver::decisions() const { return impl->numDecisions; }
+uint64_t SatSolver::propagations() const { return impl->numPropagations; }
+
+} // namespace abstracttf
@@ -0,0 +1,50 @@
+// Record the mulhs queries of a set of IR modules into a KnownBits trace
+// that `testMulhs --replay` can benchmark.
+
+#include "AbstractTF/IRCorpus.h"
+#include "AbstractTF/Parallel.h"
+#include "AbstractTF/Trace.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace abstracttf;
+
+int main(int argc, char *argv[]) {
+  if (argc < 3) {
+    std::cout << "Usage: recordTrace <trace.bin> <files.ll/.bc...>"
+              << std::endl;
+    return 1;
+  }
+
+  std::vector<std::string> files(argv + 2, argv + argc);
+  CorpusScanResult scan = scanCorpus(files, defaultThreadCount());
+  for (const std::string &error : scan.errors)
+    std::cerr << error << std::endl;
+
+  TraceWriter writer;
+  std::string error;
+  if (!writer.open(argv[1], error)) {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+
+  uint64_t skipped = 0;
+  for (const MulhsSite &site : scan.sites) {
+    if (site.getBitWidth() > MaxTraceBitWidth) {
+      skipped++;
+      continue;
+    }
+    writer.record(TraceOp::Mulhs, site.lhs, site.rhs);
+  }
+  writer.close();
+
+  std::cout << "Recorded " << writer.size() << " queries from "
+            << scan.modulesParsed << " modules to " << argv[1];
+  if (skipped)
+    std::cout << " (" << skipped << " wider than " << MaxTraceBitWidth
+              << " bits skipped)";
+  std::cout << std::endl;
+  return scan.errors.empty() ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+#!/usr/bin/env bash
+#
+# Two-stage profile-guided build of testMulhs.
+#
+#   1. Build a plain Release testMulhs as the baseline.
+#   2. Build an instrumented testMulhs and run it on a small-width training
+#      sweep (both the fixed-width and the generic APInt paths).
+#   3. Rebuild with the collected profile.
+#   4. Time the baseline and the optimized binary on the benchmark widths and
+#      write a speedup report.
+#
+# Usage: scripts/pgo.sh [build-root]
+#
+# Environment:
+#   CMAKE_ARGS     extra arguments for every configure (e.g. -DCMAKE_PREFIX_PATH=...)
+#   LTO            OFF, Thin or Full for both builds (default: OFF)
+#   TRAIN_WIDTHS   widths for the training sweep (default: "1 2 3 4 5 6")
+#   BENCH_WIDTHS   widths for the speedup measurement (default: "6 7")
+#   BENCH_RUNS     runs per binary and width; the best one is kept (default: 3)
+
+set -euo pipefail
+
+SRC_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+BUILD_ROOT="${1:-${SRC_DIR}/build-pgo}"
+LTO="${LTO:-OFF}"
+TRAIN_WIDTHS="${TRAIN_WIDTHS:-1 2 3 4 5 6}"
+BENCH_WIDTHS="${BENCH_WIDTHS:-6 7}"
+BENCH_RUNS="${BENCH_RUNS:-3}"
+JOBS="$(nproc 2>/dev/null || echo 4)"
+read -r -a EXTRA_ARGS <<< "${CMAKE_ARGS:-}"
+
+BASE_DIR="${BUILD_ROOT}/baseline"
+PGO_DIR="${BUILD_ROOT}/pgo"
+PROFILE_DIR="${PGO_DIR}/pgo-profile"
+REPORT="${BUILD_ROOT}/pgo-report.txt"
+
+configure() {
+  local dir="$1"
+  shift
+  cmake -S "${SRC_DIR}" -B "${dir}" -DCMAKE_BUILD_TYPE=Release \
+    -DABSTRACTTF_LTO="${LTO}" "${EXTRA_ARGS[@]}" "$@" > /dev/null
+}
+
+build() {
+  cmake --build "$1" --target testMulhs -j"${JOBS}" > /dev/null
+}
+
+# Best wall-clock time in seconds over BENCH_RUNS runs of `$@`
+best_time() {
+  local best=""
+  for _ in $(seq "${BENCH_RUNS}"); do
+    local start end elapsed
+    start=$(date +%s%N)
+    "$@" > /dev/null
+    end=$(date +%s%N)
+    elapsed=$(( end - start ))
+    if [[ -z "${best}" || ${elapsed} -lt ${best} ]]; then
+      best=${elapsed}
+    fi
+  done
+  awk -v ns="${best}" 'BEGIN { printf "%.3f", ns / 1e9 }'
+}
+
+echo "== Baseline build (${BASE_DIR})"
+configure "${BASE_DIR}" -DABSTRACTTF_PGO=OFF
+build "${BASE_DIR}"
+
+echo "== Instrumented build (${PGO_DIR})"
+rm -rf "${PROFILE_DIR}"
+configure "${PGO_DIR}" -DABSTRACTTF_PGO=Generate \
+  -DABSTRACTTF_PGO_DIR="${PROFILE_DIR}"
+build "${PGO_DIR}"
+
+echo "== Training sweep on widths: ${TRAIN_WIDTHS}"
+for bw in ${TRAIN_WIDTHS}; do
+  "${PGO_DIR}/testMulhs" "${bw}" > /dev/null
+  "${PGO_DIR}/testMulhs" --generic "${bw}" > /dev/null
+done
+
+if ls "${PROFILE_DIR}"/*.profraw > /dev/null 2>&1; then
+  PROFDATA="$(command -v llvm-profdata || true)"
+  if [[ -z "${PROFDATA}" ]]; then
+    echo "llvm-profdata is required to merge Clang profiles" >&2
+    exit 1
+  fi
+  "${PROFDATA}" merge -o "${PROFILE_DIR}/default.profdata" \
+    "${PROFILE_DIR}"/*.profraw
+fi
+
+echo "== Optimized build (${PGO_DIR})"
+configure "${PGO_DIR}" -DABSTRACTTF_PGO=Use \
+  -DABSTRACTTF_PGO_DIR="${PROFILE_DIR}"
+build "${PGO_DIR}"
+
+echo "== Measuring"
+{
+  echo "testMulhs PGO speedup report"
+  echo "LTO: ${LTO}, training widths: ${TRAIN_WIDTHS}, best of ${BENCH_RUNS} runs"
+  printf "%-22s %12s %12s %9s\n" "Sweep" "Baseline(s)" "PGO(s)" "Speedup"
+  for bw in ${BENCH_WIDTHS}; do
+    for mode in "" "--generic"; do
+      base=$(best_time "${BASE_DIR}/testMulhs" ${mode} "${bw}")
+      opt=$(best_time "${PGO_DIR}/testMulhs" ${mode} "${bw}")
+      label="width ${bw}${mode:+ ${mode}}"
+      awk -v l="${label}" -v b="${base}" -v o="${opt}" \
+        'BEGIN { printf "%-22s %12.3f %12.3f %8.2fx\n", l, b, o, b / o }'
+    done
+  done
+} | tee "${REPORT}"
+
+echo "Report written to ${REPORT}"
@@ -1,215 +1,290 @@
 // Author: Jacob Knowlton
 // Date:   Nov 2024
 
+#include "AbstractTF/Enumeration.h"
+#include "AbstractTF/FixedWidthSweep.h"
+#include "AbstractTF/Oracle.h"
+#include "AbstractTF/Parallel.h"
+#include "AbstractTF/Progress.h"
+#include "AbstractTF/Sweep.h"
+#include "driver/Modes.h"
+
+#include <algorithm>
 #include <chrono>
+#include <cstdlib>
 #include <iostream>
-#include <llvm/ADT/APInt.h>
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/Optional.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/StringRef.h>
 #include <llvm/Support/KnownBits.h>
 #include <string>
 #include <vector>
 
-using llvm::APInt;
 using llvm::KnownBits;
-
-std::vector<KnownBits> enumerateFromBitWidth(unsigned bitWidth) {
-  // Each KnownBit can be either 0, 1, or unknown.
-  // This corresponds to finding all tertiary numbers
-  // with bitwidth of `bitWidth`
-  uint64_t total = 1;
-  for (unsigned i = 0; i < bitWidth; i++) {
-    total *= 3;
-  }
-
-  std::vector<KnownBits> result;
-  result.reserve(total); // We know there will be `total` numbers
-
-  for (uint64_t i = 0; i < total; i++) {
-    KnownBits kb(bitWidth);
-    uint64_t temp = i;
-
-    for (unsigned bit = 0; bit < bitWidth; bit++) {
-      uint64_t digit = temp % 3; // 0, 1, or unknown
-      temp /= 3;                 // Move to next tertiary "bit"
-      if (digit == 0) {          // Check cases
-        kb.Zero.setBit(bit);
-      } else if (digit == 1) {
-        kb.One.setBit(bit);
-      }
-    }
-
-    assert(!kb.hasConflict() && "Known 0s and 1s should not conflict");
-
-    result.push_back(kb);
-  }
-
-  return result;
-}
-
-std::vector<APInt> concretization(const KnownBits &kb) {
-  unsigned bw = kb.getBitWidth();
-
-  // Find the indexes of all unknown values
-  std::vector<unsigned> unknownIndexes;
-  for (unsigned i = 0; i < bw; i++) {
-    if (!kb.Zero[i] && !kb.One[i]) {
-      unknownIndexes.push_back(i);
-    }
+using namespace abstracttf;
+
+void testMulhsTransferFunctions(unsigned BitWidth, bool forceGeneric,
+                                unsigned numThreads,
+                                std::chrono::seconds progressInterval,
+                                bool profileLatency, unsigned slowestCount,
+                                bool reportBusy) {
+  uint64_t totalKnownBits = numKnownBits(BitWidth);
+  ProgressReporter progress("mulhs bw=" + std::to_string(BitWidth),
+                            totalKnownBits * totalKnownBits, numThreads,
+                            progressInterval, std::cerr);
+  SweepOptions options;
+  options.numThreads = numThreads;
+  options.progress = &progress;
+  LatencyProfile latency(BitWidth, slowestCount);
+  if (profileLatency)
+    options.latency = &latency;
+  ScheduleStats schedule;
+  options.schedule = &schedule;
+
+  SweepResult result;
+  // Widths 1-16 have compile-time specialized kernels
+  if (FixedSweepFn fixedSweep = getMulhsFixedWidthSweep(BitWidth);
+      fixedSweep && !forceGeneric) {
+    result = fixedSweep(options);
+  } else {
+    std::vector<KnownBits> allKnownBits = enumerateFromBitWidth(BitWidth);
+    result = sweepTransferFunctions(allKnownBits, KnownBits::mulhs, naiveMulhs,
+                                    options);
   }
 
-  // All possible combinations is 2^numUnknownIndexes
-  uint64_t total = 1ull << unknownIndexes.size();
-
-  std::vector<APInt> result;
-
-  for (uint64_t i = 0; i < total; i++) {
-    APInt ap = kb.One; // Start with all values known to be 1
-    uint64_t temp = i;
-    for (const unsigned unknownIdx : unknownIndexes) {
-      if (temp & 1) {
-        ap.setBit(unknownIdx);
-      } else {
-        ap.clearBit(unknownIdx);
-      }
-      temp /= 2;
-    }
-    result.push_back(ap);
-  }
-
-  return result;
+  printSweepResult(std::cout, "mulhs", result);
+  if (profileLatency)
+    latency.print(std::cout);
+  if (reportBusy)
+    schedule.print(std::cout);
 }
 
-KnownBits abstraction(const std::vector<APInt> &values) {
-  assert(!values.empty() && "Values set should not be empty");
-  unsigned bw = values.begin()->getBitWidth();
-
-  APInt knownZero = APInt::getAllOnes(bw);
-  APInt knownOne = APInt::getAllOnes(bw);
-
-  for (const APInt &value : values) {
-    assert(value.getBitWidth() == bw &&
-           "All values must have the same bitwidth");
-    knownZero &= ~value;
-    knownOne &= value;
-  }
-
-  KnownBits kb(bw);
-  kb.Zero = knownZero;
-  kb.One = knownOne;
-
-  return kb;
+static void printUsage() {
+  std::cout << "Usage: testMulhs [--generic] [--threads N] [--progress SECONDS] "
+               "[--latency [--slowest N]] [--busy] <bitWidth>"
+            << std::endl;
+  std::cout << "       testMulhs [--threads N] [--progress SECONDS] "
+               "[--busy] --ops <all|op,op,...> <bitWidth>"
+            << std::endl;
+  std::cout << "       testMulhs [--threads N] [--progress SECONDS] "
+               "--unary <all|op,op,...> <bitWidth>"
+            << std::endl;
+  std::cout << "       testMulhs [--threads N] [--progress SECONDS] "
+               "[--latency [--slowest N]] [--busy] "
+               "--icmp <all|pred,pred,...> <bitWidth>"
+            << std::endl;
+  std::cout << "       testMulhs [--threads N] [--progress SECONDS] "
+               "[--busy] --range <all|op,op,...> <bitWidth>"
+            << std::endl;
+  std::cout << "       testMulhs [--threads N] [--progress SECONDS] "
+               "[--busy] --reduced <bitWidth>"
+            << std::endl;
+  std::cout << "       testMulhs [--threads N] [--progress SECONDS] "
+               "[--examples N] --monotone <all|op,op,...> <bitWidth>"
+            << std::endl;
+  std::cout << "       testMulhs [--threads N] [--progress SECONDS] "
+               "[--examples N] --counterexamples <bitWidth>"
+            << std::endl;
+  std::cout << "       testMulhs [--threads N] [--progress SECONDS] "
+               "--saturation <bitWidth>"
+            << std::endl;
+  std::cout << "       testMulhs [--threads N] [--progress SECONDS] "
+               "--algorithms <bitWidth>"
+            << std::endl;
+  std::cout << "       testMulhs [--threads N] --ir <files...>" << std::endl;
+  std::cout << "       testMulhs [--threads N] [--batch N] --replay <trace.bin>"
+            << std::endl;
+  std::cout << "       testMulhs [--threads N] [--progress SECONDS] "
+               "[--tables N] [--table-dir DIR] --daemon <socket>"
+            << std::endl;
+  std::cout << "       testMulhs [--threads N] [--batch N] [--tables N] "
+               "[--table-dir DIR] --stream <file|->"
+            << std::endl;
+  std::cout << "       testMulhs --query <socket> <lhs> <rhs> [<lhs> <rhs> ...]"
+            << std::endl;
+  std::cout << "       testMulhs [--threads N] --sat <bitWidth> [count] [seed]"
+            << std::endl;
 }
 
-KnownBits naiveMulhs(const KnownBits &lhs, const KnownBits &rhs) {
-  unsigned bw = lhs.getBitWidth();
-  assert(bw == rhs.getBitWidth() && "RHS and LHS must have the same bitwidth");
-  std::vector<APInt> concreteLhs = concretization(lhs);
-  std::vector<APInt> concreteRhs = concretization(rhs);
-
-  std::vector<APInt> cfResult;
-  for (const APInt cLhs : concreteLhs) {
-    for (const APInt cRhs : concreteRhs) {
-      APInt wideLhs = cLhs.sext(2 * bw);
-      APInt wideRhs = cRhs.sext(2 * bw);
-      APInt prod = wideLhs * wideRhs;
-      APInt highBits =
-          prod.extractBits(bw, bw); // Extract bits starting at bw, length bw
-      cfResult.push_back(highBits);
+// Appends the comma-separated names in `list` to `out`, "all" standing for
+// every entry of `all`. Reports the first unknown name as "Unknown `what`".
+template <typename T>
+static bool parseNameList(llvm::StringRef list, llvm::ArrayRef<T> all,
+                          llvm::Optional<T> (*parse)(llvm::StringRef),
+                          const char *what, std::vector<T> &out) {
+  llvm::SmallVector<llvm::StringRef, 16> names;
+  list.split(names, ',', -1, /*KeepEmpty=*/false);
+  for (llvm::StringRef name : names) {
+    if (name == "all") {
+      out.assign(all.begin(), all.end());
+    } else if (llvm::Optional<T> value = parse(name)) {
+      out.push_back(*value);
+    } else {
+      std::cerr << "Unknown " << what << ": " << name.str() << std::endl;
+      return false;
     }
   }
-  return abstraction(cfResult);
+  return true;
 }
 
-void testMulhsTransferFunctions(unsigned BitWidth) {
-  std::vector<KnownBits> allKnownBits = enumerateFromBitWidth(BitWidth);
-  uint64_t totalKnownBits = allKnownBits.size();
-
-  uint64_t compositeMorePrecise = 0;
-  uint64_t naiveMorePrecise = 0;
-  uint64_t samePrecision = 0;
-  uint64_t incomparableResults = 0;
-
-  double totalTimeComposite = 0.0;
-  double totalTimeNaive = 0.0;
-
-  // Iterate through all pairs
-  for (size_t i = 0; i < totalKnownBits; i++) {
-    for (size_t j = 0; j < totalKnownBits; j++) {
-      const KnownBits &LHS = allKnownBits[i];
-      const KnownBits &RHS = allKnownBits[j];
-
-      // Compute composite and naive mulhs
-      auto t1 = std::chrono::high_resolution_clock::now();
-      KnownBits composite = KnownBits::mulhs(LHS, RHS);
-      auto t2 = std::chrono::high_resolution_clock::now();
-      totalTimeComposite += (t2 - t1).count();
-
-      t1 = std::chrono::high_resolution_clock::now();
-      KnownBits naive = naiveMulhs(LHS, RHS);
-      t2 = std::chrono::high_resolution_clock::now();
-      totalTimeNaive += (t2 - t1).count();
-
-      // Check if results are comparable
-      bool isIncomparable = false;
-      for (int k = 0; k < BitWidth; k++) {
-        if ((composite.Zero[k] && naive.One[k]) ||
-            (composite.One[k] && naive.Zero[k])) {
-          incomparableResults++;
-          isIncomparable = true;
-          break;
-        }
+int main(int argc, char *argv[]) {
+  bool forceGeneric = false;
+  unsigned numThreads = defaultThreadCount();
+  size_t batchSize = 4096;
+  std::chrono::seconds progressInterval(10);
+  bool profileLatency = false;
+  bool reportBusy = false;
+  unsigned slowestCount = 10;
+  unsigned exampleCount = 10;
+  const char *replayTrace = nullptr;
+  const char *daemonSocket = nullptr;
+  const char *streamInput = nullptr;
+  unsigned tableWidth = 7;
+  std::string tableDir;
+  std::vector<BinaryOp> ops;
+  std::vector<UnaryOp> unaryOps;
+  std::vector<ICmpPredicate> preds;
+  std::vector<RangeOp> rangeOps;
+  bool reducedProduct = false;
+  std::vector<BinaryOp> monotoneOps;
+  bool counterexamples = false;
+  bool saturation = false;
+  bool algorithms = false;
+  const char *bwArg = nullptr;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--generic") {
+      forceGeneric = true;
+    } else if (arg == "--threads" && i + 1 < argc) {
+      numThreads = std::max(1, std::atoi(argv[++i]));
+    } else if (arg == "--progress" && i + 1 < argc) {
+      progressInterval = std::chrono::seconds(std::max(0, std::atoi(argv[++i])));
+    } else if (arg == "--busy") {
+      reportBusy = true;
+    } else if (arg == "--latency") {
+      profileLatency = true;
+    } else if (arg == "--slowest" && i + 1 < argc) {
+      slowestCount = std::max(0, std::atoi(argv[++i]));
+    } else if (arg == "--examples" && i + 1 < argc) {
+      exampleCount = std::max(0, std::atoi(argv[++i]));
+    } else if (arg == "--batch" && i + 1 < argc) {
+      batchSize = std::max(1, std::atoi(argv[++i]));
+    } else if (arg == "--ops" && i + 1 < argc) {
+      if (!parseNameList(argv[++i], llvm::makeArrayRef(AllBinaryOps),
+                         parseBinaryOp, "operator", ops))
+        return 1;
+    } else if (arg == "--unary" && i + 1 < argc) {
+      if (!parseNameList(argv[++i], llvm::makeArrayRef(AllUnaryOps),
+                         parseUnaryOp, "unary operator", unaryOps))
+        return 1;
+    } else if (arg == "--icmp" && i + 1 < argc) {
+      if (!parseNameList(argv[++i], llvm::makeArrayRef(AllICmpPredicates),
+                         parseICmpPredicate, "icmp predicate", preds))
+        return 1;
+    } else if (arg == "--range" && i + 1 < argc) {
+      if (!parseNameList(argv[++i], llvm::makeArrayRef(AllRangeOps),
+                         parseRangeOp, "range operator", rangeOps))
+        return 1;
+    } else if (arg == "--monotone" && i + 1 < argc) {
+      if (!parseNameList(argv[++i], llvm::makeArrayRef(AllBinaryOps),
+                         parseBinaryOp, "operator", monotoneOps))
+        return 1;
+    } else if (arg == "--counterexamples") {
+      counterexamples = true;
+    } else if (arg == "--algorithms") {
+      algorithms = true;
+    } else if (arg == "--saturation") {
+      saturation = true;
+    } else if (arg == "--reduced") {
+      reducedProduct = true;
+    } else if (arg == "--replay" && i + 1 < argc) {
+      replayTrace = argv[++i];
+    } else if (arg == "--daemon" && i + 1 < argc) {
+      daemonSocket = argv[++i];
+    } else if (arg == "--stream" && i + 1 < argc) {
+      streamInput = argv[++i];
+    } else if (arg == "--tables" && i + 1 < argc) {
+      tableWidth = std::max(0, std::atoi(argv[++i]));
+    } else if (arg == "--table-dir" && i + 1 < argc) {
+      tableDir = argv[++i];
+    } else if (arg == "--query" && i + 1 < argc) {
+      // Everything after the socket is an operand, in pairs
+      std::vector<std::string> operands(argv + i + 2, argv + argc);
+      if (operands.empty() || operands.size() % 2 != 0) {
+        printUsage();
+        return 1;
       }
-      if (isIncomparable)
-        continue;
-
-      // Check which transfer function is more precise
-      unsigned compositePrecision =
-          composite.Zero.countPopulation() + composite.One.countPopulation();
-      unsigned naivePrecision =
-          naive.Zero.countPopulation() + naive.One.countPopulation();
-
-      if (compositePrecision > naivePrecision)
-        compositeMorePrecise++;
-      else if (naivePrecision > compositePrecision)
-        naiveMorePrecise++;
-      else
-        samePrecision++;
+      return runQueryMode(argv[i + 1], operands);
+    } else if (arg == "--sat" && i + 1 < argc) {
+      unsigned satWidth = std::atoi(argv[i + 1]);
+      uint64_t count = i + 2 < argc ? std::strtoull(argv[i + 2], nullptr, 10) : 16;
+      uint64_t seed = i + 3 < argc ? std::strtoull(argv[i + 3], nullptr, 10) : 1;
+      if (satWidth == 0 || count == 0) {
+        printUsage();
+        return 1;
+      }
+      return runSatMode(satWidth, count, seed, numThreads);
+    } else if (arg == "--ir") {
+      // Everything after --ir is an input module
+      std::vector<std::string> files(argv + i + 1, argv + argc);
+      if (files.empty()) {
+        printUsage();
+        return 1;
+      }
+      return runIRCorpusMode(files, numThreads);
+    } else {
+      bwArg = argv[i];
     }
   }
 
-  // Calculate average time
-  double avgTimeComposite =
-      totalTimeComposite / (totalKnownBits * totalKnownBits);
-  double avgTimeNaive = totalTimeNaive / (totalKnownBits * totalKnownBits);
-
-  // Report results
-  std::cout << "Testing mulhs Transfer Functions for BitWidth = " << BitWidth
-            << std::endl;
-  std::cout << "Total abstract values: " << totalKnownBits << std::endl;
-  std::cout << "Composite transfer function more precise: "
-            << compositeMorePrecise << std::endl;
-  std::cout << "Naive transfer function more precise: " << naiveMorePrecise
-            << std::endl;
-  std::cout << "Same precision for both transfer functions: " << samePrecision
-            << std::endl;
-  std::cout << "Incomparable results: " << incomparableResults << std::endl;
-  std::cout << "Average composite time: " << avgTimeComposite << std::endl;
-  std::cout << "Average naive time: " << avgTimeNaive << std::endl << std::endl;
-}
-
-int main(int argc, char *argv[]) {
-  if (argc < 2) {
-    std::cout << "Usage: testMulhs <bitWidth>" << std::endl;
+  if (replayTrace)
+    return runReplayMode(replayTrace, numThreads, batchSize);
+  if (streamInput)
+    return runStreamMode(streamInput, batchSize, tableWidth, tableDir,
+                         numThreads, progressInterval);
+  if (daemonSocket)
+    return runDaemonMode(daemonSocket, tableWidth, tableDir, numThreads,
+                         progressInterval);
+
+  if (!bwArg) {
+    printUsage();
     return 1;
   }
 
   // Try to parse bitwidth from cmdline
   unsigned bw = 6;
   try {
-    bw = std::stoi(argv[1]);
+    bw = std::stoi(bwArg);
   } catch (std::invalid_argument) {
     bw = 4;
   }
 
-  testMulhsTransferFunctions(bw);
+  installStatusSignalHandler();
+  if (!ops.empty())
+    return runMultiOpMode(ops, bw, numThreads, progressInterval, reportBusy);
+  if (!unaryOps.empty())
+    return runUnaryMode(unaryOps, bw, numThreads, progressInterval);
+  if (!preds.empty())
+    return runICmpMode(preds, bw, numThreads, progressInterval,
+                       profileLatency, slowestCount, reportBusy);
+  if (!rangeOps.empty())
+    return runRangeMode(rangeOps, bw, numThreads, progressInterval,
+                        reportBusy);
+  if (!monotoneOps.empty())
+    return runMonotoneMode(monotoneOps, bw, numThreads, progressInterval,
+                           exampleCount);
+  if (counterexamples)
+    return runCounterexampleMode(bw, numThreads, progressInterval,
+                                 exampleCount);
+  if (algorithms)
+    return runAlgorithmMode(bw, numThreads, progressInterval);
+  if (saturation)
+    return runSaturationMode(bw, numThreads, progressInterval);
+  if (reducedProduct)
+    return runReducedProductMode(bw, numThreads, progressInterval,
+                                 reportBusy);
+  testMulhsTransferFunctions(bw, forceGeneric, numThreads, progressInterval,
+                             profileLatency, slowestCount, reportBusy);
   return 0;
 }
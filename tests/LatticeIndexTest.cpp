@@ -0,0 +1,124 @@
+// Checks of LatticeIndex against the digit-by-digit knownBitsFromRank: the
+// rank/mask round trip, the per-level generator and the child/parent edges,
+// at widths that do and do not fill whole eight-digit table chunks.
+
+#include "AbstractTF/Enumeration.h"
+#include "AbstractTF/LatticeIndex.h"
+
+#include <iostream>
+#include <llvm/Support/KnownBits.h>
+#include <random>
+#include <vector>
+
+using namespace abstracttf;
+
+static int failures = 0;
+
+static void check(bool condition, const char *what, unsigned bw) {
+  if (!condition) {
+    std::cerr << "FAILED at width " << bw << ": " << what << std::endl;
+    failures++;
+  }
+}
+
+static void checkRank(const LatticeIndex &index, uint64_t rank) {
+  unsigned bw = index.getBitWidth();
+  KnownBits expected = knownBitsFromRank(bw, rank);
+  RankMasks masks = index.masksOf(rank);
+  check(masks.Zero == expected.Zero.getZExtValue() &&
+            masks.One == expected.One.getZExtValue(),
+        "masksOf agrees with knownBitsFromRank", bw);
+  check(index.rankOf(masks.Zero, masks.One) == rank,
+        "rankOf inverts masksOf", bw);
+  check(index.level(rank) == bw - expected.Zero.countPopulation() -
+                                 expected.One.countPopulation(),
+        "level counts the unknown bits", bw);
+}
+
+// Every value with k unknown bits comes out of forEachAtLevel exactly once
+static void checkLevels(const LatticeIndex &index) {
+  unsigned bw = index.getBitWidth();
+  std::vector<bool> seen(index.size());
+  uint64_t total = 0;
+  for (unsigned k = 0; k <= bw; k++) {
+    uint64_t count = 0;
+    index.forEachAtLevel(k, [&](uint64_t rank, uint32_t unknown) {
+      count++;
+      if (rank >= index.size()) {
+        check(false, "forEachAtLevel rank in range", bw);
+        return;
+      }
+      check(!seen[rank], "forEachAtLevel visits each rank once", bw);
+      seen[rank] = true;
+      check(index.unknownMask(rank) == unknown,
+            "forEachAtLevel passes the rank's unknown mask", bw);
+      check(index.level(rank) == k, "forEachAtLevel stays on its level", bw);
+    });
+    check(count == index.levelSize(k), "levelSize matches forEachAtLevel",
+          bw);
+    total += count;
+  }
+  check(total == index.size(), "the levels partition the lattice", bw);
+}
+
+// Children are one refinement down, and each lists its parent among its
+// own parents
+static void checkEdges(const LatticeIndex &index, uint64_t rank) {
+  unsigned bw = index.getBitWidth();
+  unsigned level = index.level(rank);
+  unsigned children = 0;
+  index.forEachChild(rank, [&](uint64_t child, unsigned bit) {
+    children++;
+    check(index.level(child) == level - 1, "child is one level down", bw);
+    bool value = index.masksOf(child).One >> bit & 1;
+    check(index.childRank(rank, bit, value) == child,
+          "forEachChild agrees with childRank", bw);
+    check(index.parentRank(child, bit, value) == rank,
+          "parentRank inverts childRank", bw);
+    unsigned matches = 0;
+    index.forEachParent(child, [&](uint64_t parent, unsigned parentBit) {
+      matches += parent == rank && parentBit == bit;
+    });
+    check(matches == 1, "child lists its parent once", bw);
+  });
+  check(children == 2 * level, "two children per unknown bit", bw);
+
+  unsigned parents = 0;
+  index.forEachParent(rank, [&](uint64_t parent, unsigned bit) {
+    parents++;
+    check(index.level(parent) == level + 1, "parent is one level up", bw);
+    check(index.unknownMask(parent) ==
+              (index.unknownMask(rank) | uint32_t(1) << bit),
+          "parent generalizes exactly its bit", bw);
+  });
+  check(parents == bw - level, "one parent per known bit", bw);
+}
+
+int main() {
+  // Exhaustively below one chunk, at one chunk and across the boundary
+  for (unsigned bw : {1u, 3u, 8u, 9u, 11u}) {
+    LatticeIndex index(bw);
+    for (uint64_t rank = 0; rank < index.size(); rank++) {
+      checkRank(index, rank);
+      checkEdges(index, rank);
+    }
+    checkLevels(index);
+  }
+
+  // Random ranks at wider widths, up to the 32-bit limit
+  std::mt19937_64 rng(0x6c617474);
+  for (unsigned bw : {17u, 23u, 31u, 32u}) {
+    LatticeIndex index(bw);
+    std::uniform_int_distribution<uint64_t> ranks(0, index.size() - 1);
+    for (int i = 0; i < 2000; i++) {
+      uint64_t rank = ranks(rng);
+      checkRank(index, rank);
+      checkEdges(index, rank);
+    }
+  }
+
+  if (failures)
+    return 1;
+  std::cout << "All lattice index checks passed" << std::endl;
+  return 0;
+}
@@ -0,0 +1,112 @@
+// Checks of the allocation-free mulhs oracles past 32 bits against the APInt
+// oracle: wordExactMulhs for widths 33-64, wideExactMulhs for 65-128, and
+// the WideInt arithmetic the latter is built on.
+
+#include "AbstractTF/MulhsOracle.h"
+#include "AbstractTF/Oracle.h"
+#include "AbstractTF/WideInt.h"
+
+#include <iostream>
+#include <llvm/ADT/APInt.h>
+#include <llvm/Support/KnownBits.h>
+#include <random>
+
+using namespace abstracttf;
+
+static int failures = 0;
+
+static void check(bool condition, const char *what, unsigned bw) {
+  if (!condition) {
+    std::cerr << "FAILED at width " << bw << ": " << what << std::endl;
+    failures++;
+  }
+}
+
+static APInt randomAPInt(std::mt19937_64 &rng, unsigned bw) {
+  uint64_t words[2] = {rng(), rng()};
+  return APInt(bw, llvm::makeArrayRef(words, (bw + 63) / 64));
+}
+
+// A random query operand with exactly `unknown` unknown bits
+static KnownBits randomKnownBits(std::mt19937_64 &rng, unsigned bw,
+                                 unsigned unknown) {
+  APInt value = randomAPInt(rng, bw);
+  APInt unknownMask(bw, 0);
+  std::uniform_int_distribution<unsigned> position(0, bw - 1);
+  while (unknownMask.countPopulation() < unknown)
+    unknownMask.setBit(position(rng));
+  KnownBits result(bw);
+  result.Zero = ~value & ~unknownMask;
+  result.One = value & ~unknownMask;
+  return result;
+}
+
+static bool sameKnownBits(const KnownBits &a, const KnownBits &b) {
+  return a.Zero == b.Zero && a.One == b.One;
+}
+
+// The 65-128 bit oracle's building blocks: sign extension, the truncating
+// product, logical shift and subtraction of WideInt<2>
+static void checkWideIntArithmetic(std::mt19937_64 &rng, unsigned bw) {
+  using Word = WideInt<2>;
+  APInt lhs = randomAPInt(rng, bw);
+  APInt rhs = randomAPInt(rng, bw);
+  Word wLhs = Word::fromAPInt(lhs);
+  Word wRhs = Word::fromAPInt(rhs);
+  check(wLhs.toAPInt(bw) == lhs, "fromAPInt/toAPInt round trip", bw);
+  check(((wLhs - wRhs) & Word::lowMask(bw)).toAPInt(bw) == lhs - rhs,
+        "subtraction", bw);
+
+  WideInt<4> wideLhs = wLhs.sext<4>(bw);
+  WideInt<4> wideRhs = wRhs.sext<4>(bw);
+  check(wideLhs.toAPInt(256) == lhs.sext(256), "sext", bw);
+  WideInt<4> product = wideLhs * wideRhs;
+  check(product.toAPInt(256).trunc(2 * bw) ==
+            lhs.sext(2 * bw) * rhs.sext(2 * bw),
+        "product", bw);
+  check((product.lshr(bw).trunc<2>() & Word::lowMask(bw)).toAPInt(bw) ==
+            concreteMulhs(lhs, rhs),
+        "high half of the product", bw);
+}
+
+static void checkOracles(std::mt19937_64 &rng, unsigned bw) {
+  std::uniform_int_distribution<unsigned> unknown(0, 4);
+  KnownBits lhs = randomKnownBits(rng, bw, unknown(rng));
+  KnownBits rhs = randomKnownBits(rng, bw, unknown(rng));
+  KnownBits expected = naiveMulhs(lhs, rhs);
+  check(sameKnownBits(exactMulhs(lhs, rhs), expected),
+        "exactMulhs agrees with naiveMulhs", bw);
+  if (bw <= 64) {
+    check(sameKnownBits(wordExactMulhs(lhs, rhs), expected),
+          "wordExactMulhs agrees with naiveMulhs", bw);
+    check(sameKnownBits(wideExactMulhs<1>(lhs, rhs), expected),
+          "wideExactMulhs<1> agrees with naiveMulhs", bw);
+  }
+  check(sameKnownBits(wideExactMulhs<2>(lhs, rhs), expected),
+        "wideExactMulhs<2> agrees with naiveMulhs", bw);
+}
+
+int main() {
+  std::mt19937_64 rng(0x6d756c6873);
+  std::uniform_int_distribution<unsigned> wordWidth(33, 64);
+  std::uniform_int_distribution<unsigned> wideWidth(65, 128);
+
+  // The limb boundaries first, then random widths on either side of 64
+  for (unsigned bw : {33u, 63u, 64u, 65u, 127u, 128u})
+    for (int i = 0; i < 50; i++)
+      checkOracles(rng, bw);
+  for (int i = 0; i < 500; i++) {
+    checkOracles(rng, wordWidth(rng));
+    checkOracles(rng, wideWidth(rng));
+  }
+  for (unsigned bw : {65u, 127u, 128u})
+    for (int i = 0; i < 50; i++)
+      checkWideIntArithmetic(rng, bw);
+  for (int i = 0; i < 500; i++)
+    checkWideIntArithmetic(rng, wideWidth(rng));
+
+  if (failures)
+    return 1;
+  std::cout << "All mulhs oracle checks passed" << std::endl;
+  return 0;
+}
@@ -0,0 +1,62 @@
+// Checks of the embedded CDCL solver's answers and of its conflict limit.
+
+#include "AbstractTF/SatSolver.h"
+
+#include <iostream>
+#include <vector>
+
+using namespace abstracttf;
+
+// Pigeonhole principle: `pigeons` pigeons in `holes` holes, at most one per
+// hole. Unsatisfiable when pigeons > holes, and refuting it takes a number
+// of conflicts exponential in `holes`.
+static void addPigeonhole(SatSolver &solver, int pigeons, int holes) {
+  std::vector<std::vector<int>> in(pigeons, std::vector<int>(holes));
+  for (int p = 0; p < pigeons; p++)
+    for (int h = 0; h < holes; h++)
+      in[p][h] = solver.newVar();
+  for (int p = 0; p < pigeons; p++)
+    solver.addClause(in[p]);
+  for (int h = 0; h < holes; h++)
+    for (int p = 0; p < pigeons; p++)
+      for (int q = p + 1; q < pigeons; q++)
+        solver.addClause({-in[p][h], -in[q][h]});
+}
+
+static int failures = 0;
+
+static void check(bool condition, const char *what) {
+  if (!condition) {
+    std::cerr << "FAILED: " << what << std::endl;
+    failures++;
+  }
+}
+
+int main() {
+  {
+    SatSolver solver;
+    addPigeonhole(solver, 4, 3);
+    check(solver.solve() == SatSolver::Result::Unsat,
+          "pigeonhole 4/3 without a limit is Unsat");
+  }
+  {
+    SatSolver solver;
+    addPigeonhole(solver, 4, 4);
+    check(solver.solve() == SatSolver::Result::Sat,
+          "pigeonhole 4/4 is Sat");
+  }
+  // Consecutive conflicts must not run the limit past zero into "no limit"
+  for (uint64_t limit : {1, 2, 10, 100}) {
+    SatSolver solver;
+    addPigeonhole(solver, 11, 10);
+    check(solver.solve({}, limit) == SatSolver::Result::Unknown,
+          "pigeonhole 11/10 with a conflict limit is Unknown");
+    check(solver.conflicts() <= limit,
+          "no more conflicts than the limit allows");
+  }
+
+  if (failures)
+    return 1;
+  std::cout << "All SAT solver checks passed" << std::endl;
+  return 0;
+}